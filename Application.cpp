@@ -1,5 +1,7 @@
 #include "Application.hpp"
 
+#include <fstream>
+
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
 
@@ -14,12 +16,15 @@ bool Application::init()
 		return false;
 	}
 
+	// Shared by every upload, without persistent mapping support the uploads simply stay synchronous
+	cmgl::UploadRing::getDefault().create(32 * 1024 * 1024);
+
+	// Every mesh is sub-allocated from these buffers, which double whenever they run out of space
+	cmgl::GeometryArena::getDefault().create(16 * 1024 * 1024, 8 * 1024 * 1024, 4 * 1024 * 1024);
+
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
 
-	glGenVertexArrays(1, &mVAO);
-	glBindVertexArray(mVAO);
-
 	if (!mImGui.init(mWindow))
 	{
 		return false;
@@ -30,29 +35,61 @@ bool Application::init()
 
 	mClearColor = cmgl::Color::LightBlue;
 
-	if (!mTexture.loadFromFile("suzanne.png"))
-	{
-		return false;
-	}
+	// Only the shaders are built here, the mesh and the texture show up a few frames later
+	mLoader.start();
+	mLoader.loadTexture(mTexture, "suzanne.png");
+	mLoader.loadMesh(mMesh, "suzanne.obj", cmgl::Mesh::WeldVertices | cmgl::Mesh::OptimizeOverdraw | cmgl::Mesh::OptimizeVertexFetch | cmgl::Mesh::SplitIndexBuffers | cmgl::Mesh::QuantizeVertices | cmgl::Mesh::BuildMeshlets | cmgl::Mesh::GenerateLods | cmgl::Mesh::CompressCache | cmgl::Mesh::GenerateTangents | cmgl::Mesh::KeepGeometry);
 
-	if (!mShader.loadFromFile("MainShader.vert", "MainShader.frag"))
+	cmgl::Image placeholder;
+	placeholder.create(1, 1, cmgl::Color::White);
+	if (!mPlaceholderTexture.loadFromImage(placeholder))
 	{
 		return false;
 	}
 
-	if (!mMesh.loadFromFile("suzanne.obj"))
+	if (!mShader.loadFromFile("MainShader.vert", "MainShader.frag"))
 	{
 		return false;
 	}
+	mShader.setUniform("Texture", cmgl::Shader::CurrentTexture);
+	mShader.setUniformBlock("Frame", FrameBinding);
+	mShader.setUniformBlock("Material", MaterialBinding);
+	mUniforms.create();
 
 	mAsset.setMesh(mMesh);
 	mAsset.setShader(mShader);
 	mAsset.setTexture(mTexture);
+	mAsset.setPlaceholderTexture(mPlaceholderTexture);
 
 	mInstance.setAsset(mAsset);
+	mInstanceRenderer.add(mInstance);
 
 	mInstance2.setAsset(mAsset);
 	mInstance2.setPosition(3, 0, 3);
+	mInstance2Batched = false;
+
+	// Skinned on the GPU, the character is optional : without the file only its shader is built
+	if (!mSkinnedShader.loadFromFile("SkinnedShader.vert", "MainShader.frag") || !mPalettes.create(PaletteBinding))
+	{
+		return false;
+	}
+	mSkinnedShader.setUniform("Texture", cmgl::Shader::CurrentTexture);
+	mSkinnedShader.setUniformBlock("Frame", FrameBinding);
+	mSkinnedShader.setUniformBlock("Material", MaterialBinding);
+	mSkinnedShader.setUniformBlock("BonePalette", PaletteBinding);
+	if (std::ifstream("character.dae").good())
+	{
+		mSkinnedMesh.loadFromFile("character.dae");
+	}
+
+	mSkinnedAsset.setMesh(mSkinnedMesh.getMesh());
+	mSkinnedAsset.setShader(mSkinnedShader);
+	mSkinnedAsset.setTexture(mPlaceholderTexture);
+	mSkinnedAsset.setPlaceholderTexture(mPlaceholderTexture);
+
+	mSkinnedModel.setMesh(mSkinnedMesh);
+	mSkinnedModel.setAsset(mSkinnedAsset);
+	mSkinnedModel.setPosition(-3, 0, 3);
 
 	mPosition = mCamera.getPosition();
 	mDirection = glm::normalize(glm::vec3() - mPosition);
@@ -79,6 +116,7 @@ bool Application::run()
 		lastTime = time;
 
 		mWindow.pollEvents();
+		mLoader.update();
 		mImGui.newFrame();
 		update(dt);
 
@@ -86,13 +124,21 @@ bool Application::run()
 		render();
 		mImGui.render();
 		mWindow.display();
+		cmgl::UploadRing::getDefault().endFrame();
 	}
 	return true;
 }
 
 void Application::clear()
 {
+	mLoader.stop();
 	mImGui.shutdown();
+	mStaticBatch.clear();
+	mInstanceRenderer.clear();
+	mUniforms.destroy();
+	mPalettes.destroy();
+	cmgl::GeometryArena::getDefault().destroy();
+	cmgl::UploadRing::getDefault().destroy();
 }
 
 void Application::update(float dt)
@@ -133,26 +179,84 @@ void Application::update(float dt)
 		ImGui::SliderFloat("Latt", &mLinearAttenuation, 0.0f, 10.0f);
 		ImGui::SliderFloat("Qatt", &mQuadraticAttenuation, 0.0f, 10.0f);
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+		cmgl::GeometryArena& arena = cmgl::GeometryArena::getDefault();
+		const char* poolNames[] = { "Vertices", "Indices", "Tangents" };
+		for (unsigned int i = 0; i < cmgl::GeometryArena::PoolCount; i++)
+		{
+			const cmgl::GeometryArena::Statistics statistics = arena.getStatistics((cmgl::GeometryArena::Pool)i);
+			ImGui::Text("%s : %u KB / %u KB (%.1f%% used, %.1f%% fragmented, %u ranges)", poolNames[i], (unsigned int)(statistics.used / 1024), (unsigned int)(statistics.capacity / 1024),
+				100.0f * statistics.utilization, 100.0f * statistics.fragmentation, (unsigned int)statistics.allocationCount);
+		}
+		if (ImGui::Button("Defragment geometry"))
+		{
+			arena.defragment();
+		}
+
+		// Counted over the last frame, ImGui's own calls bypass the cache
+		cmgl::StateCache& cache = cmgl::StateCache::getDefault();
+		ImGui::Text("GL binds : %u issued, %u skipped", (unsigned int)cache.getStatistics().issuedCalls, (unsigned int)cache.getStatistics().skippedCalls);
+		cache.resetStatistics();
 	}
 
 	mInstance.setRotation(glm::rotate(mInstance.getRotation(), 0.3f * dt, glm::vec3(0, 1, 0)));
+
+	// dt is measured backwards by run(), the animation plays forward
+	mSkinnedModel.update(-dt);
+
+	// The second instance never moves : it joins the static batch as soon as its mesh is loaded
+	if (!mInstance2Batched)
+	{
+		mInstance2Batched = mStaticBatch.add(mInstance2);
+	}
 }
 
 void Application::render()
 {
+	const glm::mat4 view = mCamera.getViewMatrix();
+	const glm::mat4 projection = mCamera.getProjectionMatrix();
+
 	mShader.bind();
-	mShader.setUniform("Texture", cmgl::Shader::CurrentTexture);
 
-	mShader.setUniform("Ambient", cmgl::Color(mAmbient));
-	mShader.setUniform("LightColor", cmgl::Color(mLightColor));
-	mShader.setUniform("LightPosition", glm::vec3(mCamera.getViewMatrix() * glm::vec4(mCamera.getPosition(), 1.0)));
-	mShader.setUniform("EyeDirection", glm::vec3() - glm::vec3(mCamera.getViewMatrix() * glm::vec4(mCamera.getPosition(), 1.0)));
-	mShader.setUniform("Shininess", mShininess);
-	mShader.setUniform("Strength", mStrength);
-	mShader.setUniform("ConstantAttenuation", mConstantAttenuation);
-	mShader.setUniform("LinearAttenuation", mLinearAttenuation);
-	mShader.setUniform("QuadraticAttenuation", mQuadraticAttenuation);
-
-	mInstance.draw(mCamera.getViewMatrix(), mCamera.getProjectionMatrix());
-	mInstance2.draw(mCamera.getViewMatrix(), mCamera.getProjectionMatrix());
+	// Every per-frame and material value goes in one upload, the draws only bind ranges of it
+	FrameBlock frame;
+	frame.view = view;
+	frame.projection = projection;
+	frame.viewProjection = projection * view;
+	frame.ambient = glm::vec4(mAmbient.x, mAmbient.y, mAmbient.z, mAmbient.w);
+	frame.lightColor = glm::vec4(mLightColor.x, mLightColor.y, mLightColor.z, mLightColor.w);
+	frame.lightPosition = glm::vec3(view * glm::vec4(mCamera.getPosition(), 1.0));
+	frame.eyeDirection = -frame.lightPosition;
+	frame.constantAttenuation = mConstantAttenuation;
+	frame.linearAttenuation = mLinearAttenuation;
+	frame.quadraticAttenuation = mQuadraticAttenuation;
+
+	MaterialBlock material;
+	material.shininess = mShininess;
+	material.strength = mStrength;
+
+	mUniforms.clear();
+	const std::size_t frameOffset = mUniforms.add(frame);
+	const std::size_t materialOffset = mUniforms.add(material);
+	mAsset.setMaterialBlock(mUniforms, materialOffset);
+	mSkinnedAsset.setMaterialBlock(mUniforms, materialOffset);
+	mUniforms.upload();
+	mUniforms.bind(FrameBinding, frameOffset, sizeof(FrameBlock));
+
+	// Same for the bone palettes of every skinned model
+	mPalettes.clear();
+	mSkinnedModel.addPalette(mPalettes);
+	mPalettes.upload();
+
+	mInstanceRenderer.draw(view, projection);
+	if (mInstance2Batched)
+	{
+		mStaticBatch.draw(view, projection);
+	}
+	else
+	{
+		mQueue.submit(mInstance2);
+	}
+	mQueue.execute(view, projection);
+	mSkinnedModel.draw(view, projection);
 }
@@ -2,9 +2,13 @@
 
 #include <GL/glew.h>
 
+#include "Lib/AsyncLoader.hpp"
 #include "Lib/Camera.hpp"
+#include "Lib/GeometryArena.hpp"
 #include "Lib/Window.hpp"
 #include "Lib/ImGuiWrapper.hpp"
+#include "Lib/StateCache.hpp"
+#include "Lib/UploadRing.hpp"
 
 #include "Engine.hpp"
 
@@ -27,17 +31,29 @@ class Application
 		cmgl::Window mWindow;
 		cmgl::ImGuiWrapper mImGui;
 		cmgl::Camera mCamera;
-		GLuint mVAO;
 
 		ImVec4 mClearColor;
 
+		cmgl::AsyncLoader mLoader;
+
 		cmgl::Texture mTexture;
+		cmgl::Texture mPlaceholderTexture;
 		cmgl::Shader mShader;
+		cmgl::UniformBuffer mUniforms;
 		cmgl::Mesh mMesh;
+		cmgl::Shader mSkinnedShader;
+		cmgl::PaletteBuffer mPalettes;
+		cmgl::SkinnedMesh mSkinnedMesh;
 
 		ModelAsset mAsset;
 		ModelInstance mInstance;
 		ModelInstance mInstance2;
+		StaticBatch mStaticBatch;
+		InstanceRenderer mInstanceRenderer;
+		ModelQueue mQueue;
+		bool mInstance2Batched;
+		ModelAsset mSkinnedAsset;
+		SkinnedModel mSkinnedModel;
 
 		glm::vec3 mPosition;
 		glm::vec3 mDirection;
@@ -1,9 +1,78 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Lib/Bounds.hpp"
+#include "Lib/InstanceBuffer.hpp"
 #include "Lib/Mesh.hpp"
+#include "Lib/PaletteBuffer.hpp"
+#include "Lib/RenderQueue.hpp"
 #include "Lib/Shader.hpp"
+#include "Lib/SkinnedMesh.hpp"
+#include "Lib/StateCache.hpp"
 #include "Lib/Texture.hpp"
 #include "Lib/Transformable.hpp"
+#include "Lib/UniformBuffer.hpp"
+
+// Binding points of the uniform blocks MainShader and SkinnedShader read
+enum UniformBindings
+{
+	FrameBinding = 0,
+	MaterialBinding = 1,
+	PaletteBinding = 2
+};
+
+// std140 mirror of the Frame block, a float right after a vec3 shares its 16 bytes
+struct FrameBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	glm::vec4 ambient;
+	glm::vec4 lightColor;
+	glm::vec3 lightPosition;
+	float padding0;
+	glm::vec3 eyeDirection;
+	float constantAttenuation;
+	float linearAttenuation;
+	float quadraticAttenuation;
+	float padding1[2];
+};
+
+// std140 mirror of the Material block
+struct MaterialBlock
+{
+	float shininess;
+	float strength;
+	float padding[2];
+};
+
+// Per-draw uniforms of MainShader, looked up once per shader
+struct ModelUniforms
+{
+	void resolve(cmgl::Shader& shader)
+	{
+		mv = shader.getUniformHandle<glm::mat4>("MV");
+		n = shader.getUniformHandle<glm::mat3>("N");
+		mvp = shader.getUniformHandle<glm::mat4>("MVP");
+		positionOffset = shader.getUniformHandle<glm::vec3>("PositionOffset");
+		positionScale = shader.getUniformHandle<glm::vec3>("PositionScale");
+		octahedralNormals = shader.getUniformHandle<int>("OctahedralNormals");
+		instanced = shader.getUniformHandle<int>("Instanced");
+		worldSpace = shader.getUniformHandle<int>("WorldSpace");
+	}
+
+	cmgl::UniformHandle<glm::mat4> mv;
+	cmgl::UniformHandle<glm::mat3> n;
+	cmgl::UniformHandle<glm::mat4> mvp;
+	cmgl::UniformHandle<glm::vec3> positionOffset;
+	cmgl::UniformHandle<glm::vec3> positionScale;
+	cmgl::UniformHandle<int> octahedralNormals;
+	cmgl::UniformHandle<int> instanced;
+	cmgl::UniformHandle<int> worldSpace;
+};
 
 class ModelAsset
 {
@@ -12,6 +81,9 @@ class ModelAsset
 			: mMesh(nullptr)
 			, mShader(nullptr)
 			, mTexture(nullptr)
+			, mPlaceholderTexture(nullptr)
+			, mUniforms(nullptr)
+			, mMaterialOffset(0)
 		{
 		}
 
@@ -20,9 +92,11 @@ class ModelAsset
 			mMesh = &mesh;
 		}
 
+		// The shader must be loaded already, its uniforms are resolved here
 		void setShader(cmgl::Shader& shader)
 		{
 			mShader = &shader;
+			mShaderUniforms.resolve(shader);
 		}
 
 		void setTexture(cmgl::Texture& texture)
@@ -30,6 +104,29 @@ class ModelAsset
 			mTexture = &texture;
 		}
 
+		// Bound instead of the texture until it is ready
+		void setPlaceholderTexture(cmgl::Texture& texture)
+		{
+			mPlaceholderTexture = &texture;
+		}
+
+		// The MaterialBlock of the asset in a uniform buffer, bound along with the texture
+		void setMaterialBlock(const cmgl::UniformBuffer& uniforms, std::size_t offset)
+		{
+			mUniforms = &uniforms;
+			mMaterialOffset = offset;
+		}
+
+		const cmgl::UniformBuffer* getMaterialBuffer() const
+		{
+			return mUniforms;
+		}
+
+		std::size_t getMaterialOffset() const
+		{
+			return mMaterialOffset;
+		}
+
 		cmgl::Mesh* getMesh()
 		{
 			return mMesh;
@@ -40,31 +137,114 @@ class ModelAsset
 			return mShader;
 		}
 
+		const ModelUniforms& getShaderUniforms() const
+		{
+			return mShaderUniforms;
+		}
+
 		cmgl::Texture* getTexture()
 		{
 			return mTexture;
 		}
 
+		// Meshes still loading are skipped
 		void draw()
 		{
-			if (mMesh != nullptr)
+			if (mMesh != nullptr && mMesh->isReady())
 			{
-				if (mShader != nullptr)
-				{
-					mShader->bind();
-					if (mTexture != nullptr)
-					{
-						mTexture->bind();
-					}
-				}
+				bind();
 				mMesh->draw();
 			}
 		}
 
+		// Picks the level of detail from the projected size, then only submits the meshlets inside the view and facing the camera
+		void draw(const glm::mat4& mv, const glm::mat4& p)
+		{
+			if (mMesh != nullptr && mMesh->isReady())
+			{
+				bind();
+				mMesh->drawVisible(mv, p, mMesh->selectLod(mv, p));
+			}
+		}
+
+		// instanceCount copies of a level in one draw per sub-mesh, the model matrices come from the instance buffer
+		void drawInstanced(std::size_t level, const cmgl::InstanceBuffer& instances, std::size_t offset, std::size_t instanceCount)
+		{
+			if (mMesh != nullptr && mMesh->isReady())
+			{
+				bind(true);
+				mMesh->drawLodInstanced(level, instances.getBuffer(), offset, instanceCount);
+			}
+		}
+
+		// Shader and texture only, for geometry that is not the asset's mesh
+		void bindMaterial()
+		{
+			if (mShader != nullptr)
+			{
+				mShader->bind();
+				bindTexture();
+				bindMaterialBlock();
+			}
+		}
+
+		// Without any texture the unit is cleared, so that the previous draw's texture doesn't stay bound
+		void bindTexture()
+		{
+			cmgl::Texture* texture = getBoundTexture();
+			if (texture != nullptr)
+			{
+				texture->bind();
+			}
+			else
+			{
+				cmgl::StateCache::getDefault().bindTexture(0);
+			}
+		}
+
+		void bindMaterialBlock()
+		{
+			if (mUniforms != nullptr)
+			{
+				mUniforms->bind(MaterialBinding, mMaterialOffset, sizeof(MaterialBlock));
+			}
+		}
+
+		// The texture bindMaterial binds : the placeholder until the texture is ready
+		cmgl::Texture* getBoundTexture()
+		{
+			return (mTexture != nullptr && mTexture->isReady()) ? mTexture : mPlaceholderTexture;
+		}
+
+		// Uniforms describing how the mesh is stored, the shader must already be bound
+		// Instanced draws are in world space, the others read MV, N and MVP
+		void bindMesh(bool instanced = false)
+		{
+			if (mShader != nullptr)
+			{
+				mShader->setUniform(mShaderUniforms.positionOffset, mMesh->getPositionOffset());
+				mShader->setUniform(mShaderUniforms.positionScale, mMesh->getPositionScale());
+				mShader->setUniform(mShaderUniforms.octahedralNormals, mMesh->isQuantized() ? 1 : 0);
+				mShader->setUniform(mShaderUniforms.instanced, instanced ? 1 : 0);
+				mShader->setUniform(mShaderUniforms.worldSpace, instanced ? 1 : 0);
+			}
+		}
+
+	private:
+		void bind(bool instanced = false)
+		{
+			bindMaterial();
+			bindMesh(instanced);
+		}
+
 	private:
 		cmgl::Mesh* mMesh;
 		cmgl::Shader* mShader;
+		ModelUniforms mShaderUniforms;
 		cmgl::Texture* mTexture;
+		cmgl::Texture* mPlaceholderTexture;
+		const cmgl::UniformBuffer* mUniforms;
+		std::size_t mMaterialOffset;
 };
 
 class ModelInstance : public cmgl::Transformable
@@ -72,33 +252,707 @@ class ModelInstance : public cmgl::Transformable
 	public:
 		ModelInstance()
 			: mAsset(nullptr)
+			, mBoundsDirty(true)
+			, mBoundsReady(false)
 		{
 		}
 
 		void setAsset(ModelAsset& asset)
 		{
 			mAsset = &asset;
+			mBoundsDirty = true;
+		}
+
+		ModelAsset* getAsset() const
+		{
+			return mAsset;
+		}
+
+		// World space bounds of the mesh, recomputed only after the transform changed or the mesh finished loading
+		const cmgl::BoundingBox& getWorldBoundingBox() const
+		{
+			updateBounds();
+			return mWorldBoundingBox;
+		}
+
+		const cmgl::BoundingSphere& getWorldBoundingSphere() const
+		{
+			updateBounds();
+			return mWorldBoundingSphere;
 		}
 
 		void draw(const glm::mat4& v, const glm::mat4& p)
 		{
 			if (mAsset != nullptr)
 			{
+				glm::mat4 m = getTransform();
+				glm::mat4 mv = v * m;
 				if (mAsset->getShader() != nullptr)
 				{
-					glm::mat4 m = getTransform();
-					glm::mat4 mv = v * m;
 					glm::mat4 mvp = p * mv;
 					glm::mat3 n = glm::transpose(glm::inverse(mv));
-					mAsset->getShader()->setUniform("MV", mv);
-					mAsset->getShader()->setUniform("N", n);
-					mAsset->getShader()->setUniform("MVP", mvp);
+					const ModelUniforms& uniforms = mAsset->getShaderUniforms();
+					mAsset->getShader()->setUniform(uniforms.mv, mv);
+					mAsset->getShader()->setUniform(uniforms.n, n);
+					mAsset->getShader()->setUniform(uniforms.mvp, mvp);
 				}
 
-				mAsset->draw();
+				mAsset->draw(mv, p);
 			}
 		}
 
+	protected:
+		void markAsDirty() override
+		{
+			cmgl::Transformable::markAsDirty();
+			mBoundsDirty = true;
+		}
+
+	private:
+		void updateBounds() const
+		{
+			const cmgl::Mesh* mesh = (mAsset != nullptr) ? mAsset->getMesh() : nullptr;
+			const bool ready = (mesh != nullptr && mesh->isReady());
+			if (!mBoundsDirty && ready == mBoundsReady)
+			{
+				return;
+			}
+			if (ready)
+			{
+				mWorldBoundingBox = cmgl::transformBoundingBox(mesh->getBoundingBox(), getTransform());
+				mWorldBoundingSphere = cmgl::transformBoundingSphere(mesh->getBoundingSphere(), getTransform());
+			}
+			else
+			{
+				// Nothing to see until the mesh is loaded : empty bounds at the origin of the instance
+				const glm::vec3 position(getTransform()[3]);
+				mWorldBoundingBox.min = position;
+				mWorldBoundingBox.max = position;
+				mWorldBoundingSphere.center = position;
+				mWorldBoundingSphere.radius = 0.0f;
+			}
+			mBoundsDirty = false;
+			mBoundsReady = ready;
+		}
+
 	private:
 		ModelAsset* mAsset;
+		mutable cmgl::BoundingBox mWorldBoundingBox;
+		mutable cmgl::BoundingSphere mWorldBoundingSphere;
+		mutable bool mBoundsDirty;
+		mutable bool mBoundsReady;
+};
+
+// Non-moving instances baked into one mesh per shader, texture and material block, each drawn with a single multi-draw
+// Every instance keeps its own range of the merged mesh, culled against the view with its world bounding sphere
+// The transform is baked when the instance is added : moving it means removing it and adding it again
+class StaticBatch
+{
+	public:
+		StaticBatch()
+		{
+		}
+
+		// Fails while the mesh of the instance is still loading, when it was loaded without Mesh::KeepGeometry, or when the instance is already batched
+		bool add(const ModelInstance& instance)
+		{
+			ModelAsset* asset = instance.getAsset();
+			cmgl::Mesh* mesh = (asset != nullptr) ? asset->getMesh() : nullptr;
+			if (mesh == nullptr || !mesh->isReady() || !mesh->hasGeometry() || contains(instance))
+			{
+				return false;
+			}
+
+			// Baked from the CPU copy the mesh keeps, which its next load replaces
+			const std::vector<cmgl::Vertex>& vertices = mesh->getGeometryVertices();
+			const std::vector<unsigned int>& indices = mesh->getGeometryIndices();
+			Group& group = getGroup(*asset);
+			cmgl::Mesh::SubMesh range;
+			range.indexOffset = (unsigned int)group.indices.size();
+			range.indexCount = (unsigned int)indices.size();
+			range.baseVertex = (unsigned int)group.vertices.size();
+			range.materialIndex = 0;
+
+			const glm::mat4 transform = instance.getTransform();
+			const glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+			group.vertices.reserve(group.vertices.size() + vertices.size());
+			for (std::size_t i = 0; i < vertices.size(); i++)
+			{
+				group.vertices.push_back(cmgl::Vertex(glm::vec3(transform * glm::vec4(vertices[i].position, 1.0f)), vertices[i].uv, glm::normalize(normalTransform * vertices[i].normal)));
+			}
+			group.indices.insert(group.indices.end(), indices.begin(), indices.end());
+
+			group.instances.push_back(&instance);
+			group.ranges.push_back(range);
+			group.spheres.push_back(instance.getWorldBoundingSphere());
+			group.dirty = true;
+			return true;
+		}
+
+		// Later ranges of the group move down, only the group of the instance is rebuilt
+		void remove(const ModelInstance& instance)
+		{
+			for (std::size_t g = 0; g < mGroups.size(); g++)
+			{
+				Group& group = *mGroups[g];
+				const std::vector<const ModelInstance*>::iterator it = std::find(group.instances.begin(), group.instances.end(), &instance);
+				if (it == group.instances.end())
+				{
+					continue;
+				}
+
+				const std::size_t index = (std::size_t)(it - group.instances.begin());
+				const cmgl::Mesh::SubMesh range = group.ranges[index];
+				const unsigned int vertexEnd = (index + 1 < group.ranges.size()) ? group.ranges[index + 1].baseVertex : (unsigned int)group.vertices.size();
+				const unsigned int vertexCount = vertexEnd - range.baseVertex;
+				group.vertices.erase(group.vertices.begin() + range.baseVertex, group.vertices.begin() + vertexEnd);
+				group.indices.erase(group.indices.begin() + range.indexOffset, group.indices.begin() + range.indexOffset + range.indexCount);
+				for (std::size_t i = index + 1; i < group.ranges.size(); i++)
+				{
+					group.ranges[i].baseVertex -= vertexCount;
+					group.ranges[i].indexOffset -= range.indexCount;
+				}
+				group.instances.erase(it);
+				group.ranges.erase(group.ranges.begin() + index);
+				group.spheres.erase(group.spheres.begin() + index);
+				group.dirty = true;
+				return;
+			}
+		}
+
+		bool contains(const ModelInstance& instance) const
+		{
+			for (std::size_t g = 0; g < mGroups.size(); g++)
+			{
+				if (std::find(mGroups[g]->instances.begin(), mGroups[g]->instances.end(), &instance) != mGroups[g]->instances.end())
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void clear()
+		{
+			mGroups.clear();
+		}
+
+		// Uploads the groups changed since the last call, empty groups are dropped
+		void update()
+		{
+			for (std::size_t g = 0; g < mGroups.size(); )
+			{
+				Group& group = *mGroups[g];
+				if (group.instances.empty())
+				{
+					mGroups.erase(mGroups.begin() + g);
+					continue;
+				}
+				if (group.dirty)
+				{
+					group.mesh.loadFromMemory(group.vertices.data(), group.vertices.size(), group.indices.data(), group.indices.size(), group.ranges.data(), group.ranges.size());
+					group.dirty = false;
+				}
+				g++;
+			}
+		}
+
+		// Returns the number of instances drawn
+		std::size_t draw(const glm::mat4& v, const glm::mat4& p)
+		{
+			update();
+
+			// The batches are in world space, so are the planes
+			glm::vec4 planes[6];
+			cmgl::extractFrustumPlanes(p * v, planes);
+			std::size_t drawn = 0;
+			for (std::size_t g = 0; g < mGroups.size(); g++)
+			{
+				Group& group = *mGroups[g];
+				group.visible.clear();
+				for (std::size_t i = 0; i < group.spheres.size(); i++)
+				{
+					if (cmgl::isInsideFrustum(group.spheres[i], planes))
+					{
+						group.visible.push_back(i);
+					}
+				}
+				if (group.visible.empty() || !group.mesh.isReady())
+				{
+					continue;
+				}
+
+				// Baked vertices are in world space, the view comes from the Frame block
+				group.asset->bindMaterial();
+				cmgl::Shader* shader = group.asset->getShader();
+				if (shader != nullptr)
+				{
+					const ModelUniforms& uniforms = group.asset->getShaderUniforms();
+					shader->setUniform(uniforms.positionOffset, glm::vec3(0.0f));
+					shader->setUniform(uniforms.positionScale, glm::vec3(1.0f));
+					shader->setUniform(uniforms.octahedralNormals, 0);
+					shader->setUniform(uniforms.instanced, 0);
+					shader->setUniform(uniforms.worldSpace, 1);
+				}
+				group.mesh.drawSubMeshes(group.visible.data(), group.visible.size());
+				drawn += group.visible.size();
+			}
+			return drawn;
+		}
+
+		std::size_t getGroupCount() const
+		{
+			return mGroups.size();
+		}
+
+	private:
+		struct Group
+		{
+			ModelAsset* asset; // the first asset of the group, binds the shared shader, texture and material block
+			cmgl::Shader* shader;
+			cmgl::Texture* texture;
+			const cmgl::UniformBuffer* materialBuffer;
+			std::size_t materialOffset;
+			std::vector<const ModelInstance*> instances;
+			std::vector<cmgl::Mesh::SubMesh> ranges;
+			std::vector<cmgl::BoundingSphere> spheres;
+			std::vector<cmgl::Vertex> vertices;
+			std::vector<unsigned int> indices;
+			std::vector<std::size_t> visible;
+			cmgl::Mesh mesh;
+			bool dirty;
+		};
+
+		Group& getGroup(ModelAsset& asset)
+		{
+			for (std::size_t g = 0; g < mGroups.size(); g++)
+			{
+				const Group& group = *mGroups[g];
+				if (group.shader == asset.getShader() && group.texture == asset.getTexture()
+					&& group.materialBuffer == asset.getMaterialBuffer() && group.materialOffset == asset.getMaterialOffset())
+				{
+					return *mGroups[g];
+				}
+			}
+			mGroups.push_back(std::unique_ptr<Group>(new Group()));
+			Group& group = *mGroups.back();
+			group.asset = &asset;
+			group.shader = asset.getShader();
+			group.texture = asset.getTexture();
+			group.materialBuffer = asset.getMaterialBuffer();
+			group.materialOffset = asset.getMaterialOffset();
+			group.dirty = true;
+			return group;
+		}
+
+	private:
+		std::vector<std::unique_ptr<Group>> mGroups;
+};
+
+// Instances sharing an asset drawn together : one instanced draw per asset and level of detail
+// The model matrices of the visible instances are streamed every frame, so instances can move freely
+// Instances are culled with their world bounding sphere, each one picks its own level of detail
+class InstanceRenderer
+{
+	public:
+		InstanceRenderer()
+		{
+		}
+
+		// Fails when the instance has no asset or is already added
+		bool add(ModelInstance& instance)
+		{
+			ModelAsset* asset = instance.getAsset();
+			if (asset == nullptr || contains(instance))
+			{
+				return false;
+			}
+			getBucket(*asset).instances.push_back(&instance);
+			return true;
+		}
+
+		void remove(const ModelInstance& instance)
+		{
+			for (std::size_t b = 0; b < mBuckets.size(); b++)
+			{
+				std::vector<ModelInstance*>& instances = mBuckets[b].instances;
+				const std::vector<ModelInstance*>::iterator it = std::find(instances.begin(), instances.end(), &instance);
+				if (it != instances.end())
+				{
+					instances.erase(it);
+					if (instances.empty())
+					{
+						mBuckets.erase(mBuckets.begin() + b);
+					}
+					return;
+				}
+			}
+		}
+
+		bool contains(const ModelInstance& instance) const
+		{
+			for (std::size_t b = 0; b < mBuckets.size(); b++)
+			{
+				if (std::find(mBuckets[b].instances.begin(), mBuckets[b].instances.end(), &instance) != mBuckets[b].instances.end())
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void clear()
+		{
+			mBuckets.clear();
+			mDraws.clear();
+			mBuffer.destroy();
+		}
+
+		// Returns the number of instances drawn
+		std::size_t draw(const glm::mat4& v, const glm::mat4& p)
+		{
+			// Every bucket is gathered first, so that the whole frame goes in a single upload
+			glm::vec4 planes[6];
+			cmgl::extractFrustumPlanes(p * v, planes);
+			mBuffer.clear();
+			mDraws.clear();
+			for (std::size_t b = 0; b < mBuckets.size(); b++)
+			{
+				Bucket& bucket = mBuckets[b];
+				const cmgl::Mesh* mesh = bucket.asset->getMesh();
+				if (mesh == nullptr || !mesh->isReady())
+				{
+					continue;
+				}
+
+				bucket.levels.resize(mesh->getLodCount());
+				for (std::size_t i = 0; i < bucket.instances.size(); i++)
+				{
+					const ModelInstance& instance = *bucket.instances[i];
+					if (cmgl::isInsideFrustum(instance.getWorldBoundingSphere(), planes))
+					{
+						const glm::mat4& m = instance.getTransform();
+						bucket.levels[mesh->selectLod(v * m, p)].push_back(cmgl::InstanceData(m));
+					}
+				}
+				for (std::size_t level = 0; level < bucket.levels.size(); level++)
+				{
+					std::vector<cmgl::InstanceData>& instances = bucket.levels[level];
+					if (!instances.empty())
+					{
+						Draw draw;
+						draw.asset = bucket.asset;
+						draw.level = level;
+						draw.offset = mBuffer.add(instances.data(), instances.size());
+						draw.count = instances.size();
+						mDraws.push_back(draw);
+						instances.clear();
+					}
+				}
+			}
+			if (mDraws.empty())
+			{
+				return 0;
+			}
+			mBuffer.upload();
+
+			// The instances carry their model matrix, the view comes from the Frame block
+			for (std::size_t i = 0; i < mDraws.size(); i++)
+			{
+				const Draw& draw = mDraws[i];
+				draw.asset->drawInstanced(draw.level, mBuffer, draw.offset, draw.count);
+			}
+			return mBuffer.getInstanceCount();
+		}
+
+		std::size_t getDrawCount() const
+		{
+			return mDraws.size();
+		}
+
+	private:
+		struct Bucket
+		{
+			ModelAsset* asset;
+			std::vector<ModelInstance*> instances;
+			std::vector<std::vector<cmgl::InstanceData>> levels; // visible instances of the frame, by level of detail
+		};
+
+		struct Draw
+		{
+			ModelAsset* asset;
+			std::size_t level;
+			std::size_t offset;
+			std::size_t count;
+		};
+
+		Bucket& getBucket(ModelAsset& asset)
+		{
+			for (std::size_t b = 0; b < mBuckets.size(); b++)
+			{
+				if (mBuckets[b].asset == &asset)
+				{
+					return mBuckets[b];
+				}
+			}
+			mBuckets.push_back(Bucket());
+			mBuckets.back().asset = &asset;
+			return mBuckets.back();
+		}
+
+	private:
+		std::vector<Bucket> mBuckets;
+		std::vector<Draw> mDraws;
+		cmgl::InstanceBuffer mBuffer;
+};
+
+// Mesh following an animated skeleton, skinned on the GPU by SkinnedShader
+// The pose is sampled by update(), its palette joins the PaletteBuffer of the frame and is bound for the draw
+// The asset brings the shader, texture and material, its mesh must be the one of the skinned mesh
+class SkinnedModel : public cmgl::Transformable
+{
+	public:
+		SkinnedModel()
+			: mMesh(nullptr)
+			, mAsset(nullptr)
+			, mAnimation(0)
+			, mTime(0.0f)
+			, mPalettes(nullptr)
+			, mPalette(0)
+		{
+		}
+
+		void setMesh(cmgl::SkinnedMesh& mesh)
+		{
+			mMesh = &mesh;
+			mTime = 0.0f;
+		}
+
+		void setAsset(ModelAsset& asset)
+		{
+			mAsset = &asset;
+		}
+
+		// Out of range indices keep the rest pose
+		void setAnimation(std::size_t index)
+		{
+			mAnimation = index;
+			mTime = 0.0f;
+		}
+
+		// Meshes that failed to load are skipped
+		void update(float dt)
+		{
+			if (!isReady())
+			{
+				return;
+			}
+			const cmgl::Skeleton& skeleton = mMesh->getSkeleton();
+			if (mPose.getBoneCount() != skeleton.getBoneCount())
+			{
+				mPose.reset(skeleton);
+			}
+			if (mAnimation < mMesh->getAnimationCount())
+			{
+				mTime += dt;
+				mMesh->getAnimation(mAnimation).sample(mTime, mPose);
+				mPose.computePalette(skeleton);
+			}
+		}
+
+		// Before the palettes are uploaded, the model is not drawn this frame when it has no pose yet
+		void addPalette(cmgl::PaletteBuffer& palettes)
+		{
+			mPalettes = nullptr;
+			if (isReady() && mPose.getBoneCount() > 0)
+			{
+				mPalettes = &palettes;
+				mPalette = palettes.add(mPose.getPalette(), mPose.getBoneCount());
+			}
+		}
+
+		// After the palettes are uploaded
+		void draw(const glm::mat4& v, const glm::mat4& p)
+		{
+			if (mPalettes == nullptr || mAsset == nullptr || mAsset->getShader() == nullptr)
+			{
+				return;
+			}
+
+			// Bounds are those of the rest pose, so the mesh is drawn whole rather than culled
+			mAsset->bindMaterial();
+			glm::mat4 mv = v * getTransform();
+			glm::mat4 mvp = p * mv;
+			glm::mat3 n = glm::transpose(glm::inverse(mv));
+			const ModelUniforms& uniforms = mAsset->getShaderUniforms();
+			mAsset->getShader()->setUniform(uniforms.mv, mv);
+			mAsset->getShader()->setUniform(uniforms.n, n);
+			mAsset->getShader()->setUniform(uniforms.mvp, mvp);
+			mPalettes->bind(mPalette);
+			mAsset->draw();
+		}
+
+	private:
+		bool isReady() const
+		{
+			return mMesh != nullptr && mMesh->getMesh().isReady();
+		}
+
+	private:
+		cmgl::SkinnedMesh* mMesh;
+		ModelAsset* mAsset;
+		cmgl::Pose mPose;
+		std::size_t mAnimation;
+		float mTime;
+		cmgl::PaletteBuffer* mPalettes;
+		std::size_t mPalette;
+};
+
+// Instances drawn in state order rather than submission order, through a RenderQueue
+// Shaders, textures and mesh uniforms are only bound when they change, so state changes follow the number of materials
+// Packets are culled with their world bounding sphere, opaque ones drawn front to back
+class ModelQueue
+{
+	public:
+		ModelQueue()
+			: mStateChangeCount(0)
+		{
+		}
+
+		void submit(const ModelInstance& instance, unsigned int pass = cmgl::RenderQueue::Opaque)
+		{
+			Packet packet;
+			packet.instance = &instance;
+			packet.pass = pass;
+			packet.depth = 0.0f;
+			mPackets.push_back(packet);
+		}
+
+		// Draws every packet submitted since the last call, returns the number of instances drawn
+		std::size_t execute(const glm::mat4& v, const glm::mat4& p)
+		{
+			glm::vec4 planes[6];
+			cmgl::extractFrustumPlanes(p * v, planes);
+			mQueue.clear();
+			mStateChangeCount = 0;
+
+			// Depths are spread over the range of the visible packets, for the most precision out of their key bits
+			float nearest = 0.0f;
+			float farthest = 0.0f;
+			bool visible = false;
+			for (std::size_t i = 0; i < mPackets.size(); i++)
+			{
+				Packet& packet = mPackets[i];
+				ModelAsset* asset = packet.instance->getAsset();
+				const cmgl::Mesh* mesh = (asset != nullptr) ? asset->getMesh() : nullptr;
+				const cmgl::BoundingSphere& sphere = packet.instance->getWorldBoundingSphere();
+				if (mesh == nullptr || !mesh->isReady() || !cmgl::isInsideFrustum(sphere, planes))
+				{
+					packet.pass = Culled;
+					continue;
+				}
+				packet.depth = -(v * glm::vec4(sphere.center, 1.0f)).z;
+				nearest = visible ? std::min(nearest, packet.depth) : packet.depth;
+				farthest = visible ? std::max(farthest, packet.depth) : packet.depth;
+				visible = true;
+			}
+			const float depthScale = (farthest > nearest) ? 1.0f / (farthest - nearest) : 0.0f;
+			for (std::size_t i = 0; i < mPackets.size(); i++)
+			{
+				const Packet& packet = mPackets[i];
+				if (packet.pass == Culled)
+				{
+					continue;
+				}
+				ModelAsset& asset = *packet.instance->getAsset();
+				mQueue.push(cmgl::RenderQueue::makeKey(packet.pass, getSortId(asset.getShader()), getSortId(asset.getBoundTexture()),
+					getSortId(asset.getMesh()), (packet.depth - nearest) * depthScale), (unsigned int)i);
+			}
+			mQueue.sort();
+
+			// Ids are cut to their key field, so a change is only trusted when the objects differ too
+			const cmgl::Shader* shader = nullptr;
+			const cmgl::Texture* texture = nullptr;
+			bool textureBound = false; // no texture is a state too, texture alone can't tell it from nothing bound yet
+			const cmgl::Mesh* mesh = nullptr;
+			std::size_t material = ~(std::size_t)0;
+			for (std::size_t i = 0; i < mQueue.getSize(); i++)
+			{
+				const ModelInstance& instance = *mPackets[mQueue.getPayload(i)].instance;
+				ModelAsset& asset = *instance.getAsset();
+				if (asset.getShader() == nullptr)
+				{
+					continue;
+				}
+				if (asset.getShader() != shader)
+				{
+					shader = asset.getShader();
+					shader->bind();
+					textureBound = false;
+					mesh = nullptr;
+					mStateChangeCount++;
+				}
+				if (!textureBound || asset.getBoundTexture() != texture)
+				{
+					texture = asset.getBoundTexture();
+					textureBound = true;
+					asset.bindTexture();
+					mStateChangeCount++;
+				}
+				if (asset.getMaterialOffset() != material)
+				{
+					material = asset.getMaterialOffset();
+					asset.bindMaterialBlock();
+					mStateChangeCount++;
+				}
+				if (asset.getMesh() != mesh)
+				{
+					mesh = asset.getMesh();
+					asset.bindMesh();
+					mStateChangeCount++;
+				}
+
+				glm::mat4 mv = v * instance.getTransform();
+				glm::mat4 mvp = p * mv;
+				glm::mat3 n = glm::transpose(glm::inverse(mv));
+				asset.getShader()->setUniform(asset.getShaderUniforms().mv, mv);
+				asset.getShader()->setUniform(asset.getShaderUniforms().n, n);
+				asset.getShader()->setUniform(asset.getShaderUniforms().mvp, mvp);
+				asset.getMesh()->drawVisible(mv, p, asset.getMesh()->selectLod(mv, p));
+			}
+
+			mPackets.clear();
+			return mQueue.getSize();
+		}
+
+		// Shader, texture, material and mesh binds of the last execute()
+		std::size_t getStateChangeCount() const
+		{
+			return mStateChangeCount;
+		}
+
+	private:
+		enum
+		{
+			Culled = ~0u
+		};
+
+		struct Packet
+		{
+			const ModelInstance* instance;
+			unsigned int pass;
+			float depth;
+		};
+
+		// 0 stands for no object
+		template <typename T>
+		static unsigned int getSortId(const T* object)
+		{
+			return (object != nullptr) ? object->getSortId() : 0;
+		}
+
+	private:
+		std::vector<Packet> mPackets;
+		cmgl::RenderQueue mQueue;
+		std::size_t mStateChangeCount;
 };
\ No newline at end of file
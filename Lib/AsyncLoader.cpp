@@ -0,0 +1,166 @@
+#include "AsyncLoader.hpp"
+
+#include <chrono>
+#include <memory>
+
+namespace cmgl
+{
+
+AsyncLoader::AsyncLoader()
+	: mMaxUploads(8)
+	, mPending(0)
+	, mRunning(false)
+{
+}
+
+AsyncLoader::~AsyncLoader()
+{
+	stop();
+}
+
+void AsyncLoader::start(std::size_t threadCount, std::size_t maxUploads)
+{
+	if (mRunning)
+	{
+		return;
+	}
+	if (threadCount == 0)
+	{
+		const std::size_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+	mMaxUploads = (maxUploads > 0) ? maxUploads : 1;
+	mRunning = true;
+	for (std::size_t i = 0; i < threadCount; i++)
+	{
+		mThreads.push_back(std::thread(&AsyncLoader::work, this));
+	}
+}
+
+void AsyncLoader::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRunning = false;
+	}
+	mJobAvailable.notify_all();
+	mUploadSpace.notify_all();
+	for (std::size_t i = 0; i < mThreads.size(); i++)
+	{
+		mThreads[i].join();
+	}
+	mThreads.clear();
+}
+
+void AsyncLoader::loadMesh(Mesh& mesh, const std::string& filename, unsigned int flags)
+{
+	Mesh* target = &mesh;
+	target->setState(Resource::Pending);
+	push([target, filename, flags]() -> Upload
+	{
+		std::shared_ptr<Mesh::Data> data = std::make_shared<Mesh::Data>();
+		if (!Mesh::loadDataFromFile(filename, flags, *data))
+		{
+			return [target]() { target->setState(Resource::Failed); };
+		}
+		return [target, data]() { target->loadFromData(*data); };
+	});
+}
+
+void AsyncLoader::loadTexture(Texture& texture, const std::string& filename)
+{
+	Texture* target = &texture;
+	target->setState(Resource::Pending);
+	push([target, filename]() -> Upload
+	{
+		std::shared_ptr<Image> image = std::make_shared<Image>();
+		if (!image->loadFromFile(filename))
+		{
+			return [target]() { target->setState(Resource::Failed); };
+		}
+		return [target, image]() { target->loadFromImage(*image); };
+	});
+}
+
+std::size_t AsyncLoader::update(float budget)
+{
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	const std::chrono::duration<float, std::milli> limit(budget);
+	for (;;)
+	{
+		Upload upload;
+		Job job;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!mUploads.empty())
+			{
+				upload = std::move(mUploads.front());
+				mUploads.pop_front();
+				mUploadSpace.notify_one();
+			}
+			else if (mThreads.empty() && !mJobs.empty())
+			{
+				// Without workers (not started or stopped) the CPU side runs here, against the same budget
+				job = std::move(mJobs.front());
+				mJobs.pop_front();
+			}
+		}
+		if (job)
+		{
+			upload = job();
+		}
+		if (!upload)
+		{
+			break;
+		}
+
+		upload();
+		mPending--;
+		if (std::chrono::steady_clock::now() - begin >= limit)
+		{
+			break;
+		}
+	}
+	return mPending;
+}
+
+std::size_t AsyncLoader::getPendingCount() const
+{
+	return mPending;
+}
+
+void AsyncLoader::push(const Job& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back(job);
+	}
+	mPending++;
+	mJobAvailable.notify_one();
+}
+
+void AsyncLoader::work()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;)
+	{
+		mJobAvailable.wait(lock, [this]() { return !mRunning || !mJobs.empty(); });
+		if (!mRunning)
+		{
+			return;
+		}
+		Job job = std::move(mJobs.front());
+		mJobs.pop_front();
+
+		lock.unlock();
+		Upload upload = job();
+		lock.lock();
+
+		// The queue is bounded : workers stop reading ahead while the GL thread catches up instead of piling up decoded buffers
+		// A stopping loader still keeps the result, update() hands it over later
+		mUploadSpace.wait(lock, [this]() { return !mRunning || mUploads.size() < mMaxUploads; });
+		mUploads.push_back(std::move(upload));
+	}
+}
+
+} // namespace cmgl
\ No newline at end of file
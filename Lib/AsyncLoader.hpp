@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Mesh.hpp"
+#include "Texture.hpp"
+
+namespace cmgl
+{
+
+// Loads meshes and textures in the background : worker threads read, decode and optimize,
+// then queue the finished buffers for update(), which uploads them on the GL thread
+// Requested assets are Pending until their upload ran and must outlive the loader or its stop()
+class AsyncLoader
+{
+	public:
+		AsyncLoader();
+		~AsyncLoader();
+
+		AsyncLoader(const AsyncLoader&) = delete;
+		AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+		// 0 uses every hardware thread but the GL one, without workers requests are loaded inside update()
+		void start(std::size_t threadCount = 0, std::size_t maxUploads = 8);
+		void stop();
+
+		void loadMesh(Mesh& mesh, const std::string& filename, unsigned int flags = Mesh::None);
+		void loadTexture(Texture& texture, const std::string& filename);
+
+		// GL thread only, runs finished uploads until budget milliseconds are spent (at least one per call)
+		// Returns the number of requests still in flight
+		std::size_t update(float budget = 2.0f);
+
+		std::size_t getPendingCount() const;
+
+	private:
+		typedef std::function<void()> Upload;
+		typedef std::function<Upload()> Job;
+
+		void push(const Job& job);
+		void work();
+
+	private:
+		std::vector<std::thread> mThreads;
+		std::deque<Job> mJobs;
+		std::deque<Upload> mUploads;
+		std::mutex mMutex;
+		std::condition_variable mJobAvailable;
+		std::condition_variable mUploadSpace;
+		std::size_t mMaxUploads;
+		std::size_t mPending;
+		bool mRunning;
+};
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "Bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cmgl
+{
+
+BoundingBox computeBoundingBox(const Vertex* vertices, std::size_t vertexCount)
+{
+	BoundingBox box;
+	box.min = glm::vec3(0.0f);
+	box.max = glm::vec3(0.0f);
+	if (vertexCount == 0)
+	{
+		return box;
+	}
+	box.min = box.max = vertices[0].position;
+	for (std::size_t i = 1; i < vertexCount; i++)
+	{
+		box.min = glm::min(box.min, vertices[i].position);
+		box.max = glm::max(box.max, vertices[i].position);
+	}
+	return box;
+}
+
+BoundingSphere computeBoundingSphere(const Vertex* vertices, std::size_t vertexCount)
+{
+	BoundingSphere sphere;
+	sphere.center = glm::vec3(0.0f);
+	sphere.radius = 0.0f;
+	if (vertexCount == 0)
+	{
+		return sphere;
+	}
+
+	// Extreme vertices along each axis, the pair furthest apart seeds the sphere
+	std::size_t minimum[3] = { 0, 0, 0 };
+	std::size_t maximum[3] = { 0, 0, 0 };
+	for (std::size_t i = 1; i < vertexCount; i++)
+	{
+		const glm::vec3& p = vertices[i].position;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (p[axis] < vertices[minimum[axis]].position[axis])
+			{
+				minimum[axis] = i;
+			}
+			if (p[axis] > vertices[maximum[axis]].position[axis])
+			{
+				maximum[axis] = i;
+			}
+		}
+	}
+	int seed = 0;
+	float seedDistance = -1.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const glm::vec3 d = vertices[maximum[axis]].position - vertices[minimum[axis]].position;
+		const float distance = glm::dot(d, d);
+		if (distance > seedDistance)
+		{
+			seed = axis;
+			seedDistance = distance;
+		}
+	}
+	sphere.center = (vertices[minimum[seed]].position + vertices[maximum[seed]].position) * 0.5f;
+	sphere.radius = std::sqrt(seedDistance) * 0.5f;
+
+	// Every vertex outside pulls the sphere just enough to enclose it while keeping the opposite side in place
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		const glm::vec3 d = vertices[i].position - sphere.center;
+		const float distance = glm::length(d);
+		if (distance > sphere.radius)
+		{
+			const float radius = (sphere.radius + distance) * 0.5f;
+			sphere.center += d * ((radius - sphere.radius) / distance);
+			sphere.radius = radius;
+		}
+	}
+
+	const BoundingBox box = computeBoundingBox(vertices, vertexCount);
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	float radius = 0.0f;
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		const glm::vec3 d = vertices[i].position - center;
+		radius = std::max(radius, glm::dot(d, d));
+	}
+	radius = std::sqrt(radius);
+	if (radius < sphere.radius)
+	{
+		sphere.center = center;
+		sphere.radius = radius;
+	}
+	return sphere;
+}
+
+BoundingBox transformBoundingBox(const BoundingBox& box, const glm::mat4& transform)
+{
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	const glm::vec3 extent = (box.max - box.min) * 0.5f;
+	const glm::vec3 worldCenter(transform * glm::vec4(center, 1.0f));
+	glm::vec3 worldExtent(0.0f);
+	for (int column = 0; column < 3; column++)
+	{
+		worldExtent += glm::abs(glm::vec3(transform[column])) * extent[column];
+	}
+	BoundingBox result;
+	result.min = worldCenter - worldExtent;
+	result.max = worldCenter + worldExtent;
+	return result;
+}
+
+BoundingSphere transformBoundingSphere(const BoundingSphere& sphere, const glm::mat4& transform)
+{
+	const float scale = std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+		std::max(glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])), glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))));
+	BoundingSphere result;
+	result.center = glm::vec3(transform * glm::vec4(sphere.center, 1.0f));
+	result.radius = sphere.radius * std::sqrt(scale);
+	return result;
+}
+
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+	const glm::mat4& m = viewProjection;
+	for (int i = 0; i < 3; i++)
+	{
+		planes[2 * i] = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+		planes[2 * i + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+	}
+}
+
+bool isInsideFrustum(const BoundingSphere& sphere, const glm::vec4 planes[6])
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec3 normal(planes[i]);
+		if (glm::dot(normal, sphere.center) + planes[i].w < -sphere.radius * glm::length(normal))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "Vertex.hpp"
+
+namespace cmgl
+{
+
+struct BoundingBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+BoundingBox computeBoundingBox(const Vertex* vertices, std::size_t vertexCount);
+
+// Ritter's sphere grown from the most distant pair of axis extremes, replaced by the sphere around the box center when that one is tighter
+BoundingSphere computeBoundingSphere(const Vertex* vertices, std::size_t vertexCount);
+
+// Box around the transformed box (Arvo), stays conservative under rotation
+BoundingBox transformBoundingBox(const BoundingBox& box, const glm::mat4& transform);
+
+// Radius scaled by the largest axis scale of the transform
+BoundingSphere transformBoundingSphere(const BoundingSphere& sphere, const glm::mat4& transform);
+
+// Frustum planes (a, b, c, d) of a view projection matrix, in the space it transforms from (Gribb & Hartmann)
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+// Conservative : spheres crossing a plane are inside
+bool isInsideFrustum(const BoundingSphere& sphere, const glm::vec4 planes[6]);
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "GeometryArena.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const std::size_t arena_alignment = 16;
+
+	const char* const arena_pool_names[GeometryArena::PoolCount] = { "vertices", "indices", "tangents" };
+
+	std::size_t align_arena_size(std::size_t size)
+	{
+		return (size + arena_alignment - 1) & ~(arena_alignment - 1);
+	}
+
+	unsigned int create_arena_buffer(std::size_t capacity)
+	{
+		unsigned int buffer = 0;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+		return buffer;
+	}
+}
+
+GeometryArena::GeometryArena()
+	: mNextAllocation(1)
+	, mGeneration(0)
+{
+	for (std::size_t i = 0; i < PoolCount; i++)
+	{
+		mPools[i].buffer = 0;
+		mPools[i].capacity = 0;
+		mPools[i].used = 0;
+	}
+	mInitialCapacities[Vertices] = 4 * 1024 * 1024;
+	mInitialCapacities[Indices] = 2 * 1024 * 1024;
+	mInitialCapacities[Tangents] = 1024 * 1024;
+}
+
+GeometryArena::~GeometryArena()
+{
+	destroy();
+}
+
+void GeometryArena::create(std::size_t vertexCapacity, std::size_t indexCapacity, std::size_t tangentCapacity)
+{
+	destroy();
+	mInitialCapacities[Vertices] = priv::align_arena_size(std::max(vertexCapacity, priv::arena_alignment));
+	mInitialCapacities[Indices] = priv::align_arena_size(std::max(indexCapacity, priv::arena_alignment));
+	mInitialCapacities[Tangents] = priv::align_arena_size(std::max(tangentCapacity, priv::arena_alignment));
+}
+
+void GeometryArena::destroy()
+{
+	for (std::size_t i = 0; i < PoolCount; i++)
+	{
+		PoolData& pool = mPools[i];
+		if (pool.buffer != 0)
+		{
+			glDeleteBuffers(1, &pool.buffer);
+			mGeneration++;
+		}
+		pool.buffer = 0;
+		pool.capacity = 0;
+		pool.used = 0;
+		pool.freeBySize.clear();
+		pool.freeByOffset.clear();
+		pool.allocations.clear();
+	}
+}
+
+unsigned int GeometryArena::allocate(Pool pool, std::size_t size)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	PoolData& data = mPools[pool];
+	size = priv::align_arena_size(size);
+	std::multimap<std::size_t, std::size_t>::iterator block = data.freeBySize.lower_bound(size);
+	if (block == data.freeBySize.end())
+	{
+		if (!grow(data, size))
+		{
+			fprintf(stderr, "Failed to allocate %u bytes of %s in the geometry arena\n", (unsigned int)size, priv::arena_pool_names[pool]);
+			return 0;
+		}
+		block = data.freeBySize.lower_bound(size);
+	}
+
+	// Best fit : the smallest free block that holds the range, the rest of it goes back to the free lists
+	const std::size_t blockSize = block->first;
+	const std::size_t offset = block->second;
+	removeFreeBlock(data, data.freeByOffset.find(offset));
+	if (blockSize > size)
+	{
+		addFreeBlock(data, offset + size, blockSize - size);
+	}
+
+	if (mNextAllocation == 0)
+	{
+		mNextAllocation = 1;
+	}
+	const unsigned int allocation = mNextAllocation++;
+	Range& range = data.allocations[allocation];
+	range.offset = offset;
+	range.size = size;
+	data.used += size;
+	return allocation;
+}
+
+void GeometryArena::deallocate(Pool pool, unsigned int allocation)
+{
+	PoolData& data = mPools[pool];
+	std::unordered_map<unsigned int, Range>::iterator it = data.allocations.find(allocation);
+	if (it == data.allocations.end())
+	{
+		return;
+	}
+	addFreeBlock(data, it->second.offset, it->second.size);
+	data.used -= it->second.size;
+	data.allocations.erase(it);
+}
+
+std::size_t GeometryArena::getOffset(Pool pool, unsigned int allocation) const
+{
+	std::unordered_map<unsigned int, Range>::const_iterator it = mPools[pool].allocations.find(allocation);
+	return (it != mPools[pool].allocations.end()) ? it->second.offset : 0;
+}
+
+std::size_t GeometryArena::getSize(Pool pool, unsigned int allocation) const
+{
+	std::unordered_map<unsigned int, Range>::const_iterator it = mPools[pool].allocations.find(allocation);
+	return (it != mPools[pool].allocations.end()) ? it->second.size : 0;
+}
+
+unsigned int GeometryArena::getBuffer(Pool pool) const
+{
+	return mPools[pool].buffer;
+}
+
+void GeometryArena::defragment()
+{
+	for (std::size_t i = 0; i < PoolCount; i++)
+	{
+		PoolData& pool = mPools[i];
+		if (pool.buffer == 0 || pool.freeByOffset.empty())
+		{
+			continue;
+		}
+		// Already packed when the only free block is the end of the buffer
+		if (pool.freeByOffset.size() == 1 && pool.freeByOffset.begin()->first + pool.freeByOffset.begin()->second == pool.capacity)
+		{
+			continue;
+		}
+
+		std::vector<std::pair<std::size_t, unsigned int>> order;
+		order.reserve(pool.allocations.size());
+		for (std::unordered_map<unsigned int, Range>::const_iterator it = pool.allocations.begin(); it != pool.allocations.end(); ++it)
+		{
+			order.push_back(std::make_pair(it->second.offset, it->first));
+		}
+		std::sort(order.begin(), order.end());
+
+		// Ranges keep their order, those already next to each other move in a single copy
+		const unsigned int buffer = priv::create_arena_buffer(pool.capacity);
+		glBindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+		std::size_t packed = 0;
+		std::size_t runSource = 0;
+		std::size_t runTarget = 0;
+		std::size_t runSize = 0;
+		for (std::size_t j = 0; j < order.size(); j++)
+		{
+			Range& range = pool.allocations[order[j].second];
+			if (runSize > 0 && range.offset != runSource + runSize)
+			{
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, runSource, runTarget, runSize);
+				runSize = 0;
+			}
+			if (runSize == 0)
+			{
+				runSource = range.offset;
+				runTarget = packed;
+			}
+			runSize += range.size;
+			range.offset = packed;
+			packed += range.size;
+		}
+		if (runSize > 0)
+		{
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, runSource, runTarget, runSize);
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glDeleteBuffers(1, &pool.buffer);
+		pool.buffer = buffer;
+
+		pool.freeBySize.clear();
+		pool.freeByOffset.clear();
+		if (packed < pool.capacity)
+		{
+			addFreeBlock(pool, packed, pool.capacity - packed);
+		}
+		mGeneration++;
+	}
+}
+
+unsigned int GeometryArena::getGeneration() const
+{
+	return mGeneration;
+}
+
+GeometryArena::Statistics GeometryArena::getStatistics(Pool pool) const
+{
+	const PoolData& data = mPools[pool];
+	Statistics statistics;
+	statistics.capacity = data.capacity;
+	statistics.used = data.used;
+	statistics.allocationCount = data.allocations.size();
+	statistics.freeBlockCount = data.freeByOffset.size();
+	statistics.largestFreeBlock = data.freeBySize.empty() ? 0 : data.freeBySize.rbegin()->first;
+	const std::size_t freeBytes = data.capacity - data.used;
+	statistics.utilization = (data.capacity > 0) ? (float)data.used / (float)data.capacity : 0.0f;
+	statistics.fragmentation = (freeBytes > 0) ? 1.0f - (float)statistics.largestFreeBlock / (float)freeBytes : 0.0f;
+	return statistics;
+}
+
+GeometryArena& GeometryArena::getDefault()
+{
+	static GeometryArena arena;
+	return arena;
+}
+
+bool GeometryArena::grow(PoolData& pool, std::size_t size)
+{
+	const std::size_t index = (std::size_t)(&pool - mPools);
+	std::size_t capacity = (pool.capacity > 0) ? pool.capacity * 2 : mInitialCapacities[index];
+	while (capacity < pool.capacity + size)
+	{
+		if (capacity * 2 < capacity)
+		{
+			return false;
+		}
+		capacity *= 2;
+	}
+
+	// The old content is copied on the GPU, after every upload already queued into it
+	const unsigned int buffer = priv::create_arena_buffer(capacity);
+	if (pool.buffer != 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, pool.capacity);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glDeleteBuffers(1, &pool.buffer);
+		printf("Geometry arena %s grown to %u KB\n", priv::arena_pool_names[index], (unsigned int)(capacity / 1024));
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	pool.buffer = buffer;
+
+	addFreeBlock(pool, pool.capacity, capacity - pool.capacity);
+	pool.capacity = capacity;
+	mGeneration++;
+	return true;
+}
+
+void GeometryArena::addFreeBlock(PoolData& pool, std::size_t offset, std::size_t size)
+{
+	// Merge with the free blocks right after and right before
+	std::map<std::size_t, std::size_t>::iterator next = pool.freeByOffset.lower_bound(offset);
+	if (next != pool.freeByOffset.end() && next->first == offset + size)
+	{
+		size += next->second;
+		std::map<std::size_t, std::size_t>::iterator merged = next++;
+		removeFreeBlock(pool, merged);
+	}
+	if (next != pool.freeByOffset.begin())
+	{
+		std::map<std::size_t, std::size_t>::iterator previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			offset = previous->first;
+			size += previous->second;
+			removeFreeBlock(pool, previous);
+		}
+	}
+	pool.freeByOffset[offset] = size;
+	pool.freeBySize.insert(std::make_pair(size, offset));
+}
+
+void GeometryArena::removeFreeBlock(PoolData& pool, std::map<std::size_t, std::size_t>::iterator block)
+{
+	std::pair<std::multimap<std::size_t, std::size_t>::iterator, std::multimap<std::size_t, std::size_t>::iterator> range = pool.freeBySize.equal_range(block->second);
+	for (std::multimap<std::size_t, std::size_t>::iterator it = range.first; it != range.second; ++it)
+	{
+		if (it->second == block->first)
+		{
+			pool.freeBySize.erase(it);
+			break;
+		}
+	}
+	pool.freeByOffset.erase(block);
+}
+
+} // namespace cmgl
\ No newline at end of file
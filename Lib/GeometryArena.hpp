@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+
+namespace cmgl
+{
+
+// A few large GPU buffers that every mesh sub-allocates its vertices, indices and tangents from
+// Ranges are handed out best fit from free lists ordered by size, and merged with their neighbours on release
+// A full pool moves to a buffer twice as large, defragment() packs the live ranges at the front of each pool
+// Both move ranges around : users compare getGeneration() with the one they bound and fetch the offsets again when it changed
+class GeometryArena
+{
+	public:
+		enum Pool
+		{
+			Vertices,
+			Indices,
+			Tangents,
+			PoolCount
+		};
+
+		struct Statistics
+		{
+			std::size_t capacity;
+			std::size_t used;
+			std::size_t allocationCount;
+			std::size_t freeBlockCount;
+			std::size_t largestFreeBlock;
+			float utilization; // used / capacity
+			float fragmentation; // 1 - largest free block / free bytes, 0 while the free space is in one piece
+		};
+
+	public:
+		GeometryArena();
+		~GeometryArena();
+
+		GeometryArena(const GeometryArena&) = delete;
+		GeometryArena& operator=(const GeometryArena&) = delete;
+
+		// Initial capacity of each pool in bytes, the buffers are created by the first allocation
+		void create(std::size_t vertexCapacity, std::size_t indexCapacity, std::size_t tangentCapacity);
+		void destroy();
+
+		// Ranges are 16 bytes aligned, returns 0 when the pool cannot hold size more bytes
+		unsigned int allocate(Pool pool, std::size_t size);
+		void deallocate(Pool pool, unsigned int allocation);
+
+		std::size_t getOffset(Pool pool, unsigned int allocation) const;
+		std::size_t getSize(Pool pool, unsigned int allocation) const;
+		unsigned int getBuffer(Pool pool) const;
+
+		// Copies the live ranges of every fragmented pool next to each other in a new buffer
+		void defragment();
+
+		unsigned int getGeneration() const;
+		Statistics getStatistics(Pool pool) const;
+
+		static GeometryArena& getDefault();
+
+	private:
+		struct Range
+		{
+			std::size_t offset;
+			std::size_t size;
+		};
+
+		struct PoolData
+		{
+			unsigned int buffer;
+			std::size_t capacity;
+			std::size_t used;
+			std::multimap<std::size_t, std::size_t> freeBySize; // size -> offset
+			std::map<std::size_t, std::size_t> freeByOffset; // offset -> size
+			std::unordered_map<unsigned int, Range> allocations;
+		};
+
+		bool grow(PoolData& pool, std::size_t size);
+		void addFreeBlock(PoolData& pool, std::size_t offset, std::size_t size);
+		void removeFreeBlock(PoolData& pool, std::map<std::size_t, std::size_t>::iterator block);
+
+	private:
+		PoolData mPools[PoolCount];
+		std::size_t mInitialCapacities[PoolCount];
+		unsigned int mNextAllocation;
+		unsigned int mGeneration;
+};
+
+} // namespace cmgl
\ No newline at end of file
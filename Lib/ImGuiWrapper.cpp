@@ -9,8 +9,10 @@
 #include <GLFW/glfw3native.h>
 #endif
 
+#include <cstring>
 #include <functional>
 
+#include "UploadRing.hpp"
 #include "Window.hpp"
 
 namespace cmgl
@@ -199,16 +201,42 @@ void ImGuiWrapper::render()
 	glBindVertexArray(mVaoHandle);
 	glBindSampler(0, 0); // Rely on combined texture/sampler state.
 
+	UploadRing& ring = UploadRing::getDefault();
+	unsigned int bound_buffer = 0;
 	for (int n = 0; n < draw_data->CmdListsCount; n++)
 	{
 		const ImDrawList* cmd_list = draw_data->CmdLists[n];
-		const ImDrawIdx* idx_buffer_offset = 0;
-
-		glBindBuffer(GL_ARRAY_BUFFER, mVboHandle);
-		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+		const std::size_t vtx_size = (std::size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+		const std::size_t idx_size = (std::size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementsHandle);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+		// Vertices then indices are written once into the upload ring and drawn from there,
+		// ring offsets are multiples of the vertex size so the base vertex selects this list's vertices
+		std::size_t ring_offset = 0;
+		unsigned char* staging = static_cast<unsigned char*>(ring.allocate(vtx_size + idx_size, sizeof(ImDrawVert), ring_offset));
+		const ImDrawIdx* idx_buffer_offset = 0;
+		GLint base_vertex = 0;
+		if (staging != nullptr)
+		{
+			memcpy(staging, cmd_list->VtxBuffer.Data, vtx_size);
+			memcpy(staging + vtx_size, cmd_list->IdxBuffer.Data, idx_size);
+			if (bound_buffer != ring.getBuffer())
+			{
+				bound_buffer = ring.getBuffer();
+				bindBuffers(bound_buffer, bound_buffer);
+			}
+			idx_buffer_offset = (const ImDrawIdx*)(ring_offset + vtx_size);
+			base_vertex = (GLint)(ring_offset / sizeof(ImDrawVert));
+		}
+		else
+		{
+			if (bound_buffer != mVboHandle)
+			{
+				bound_buffer = mVboHandle;
+				bindBuffers(mVboHandle, mElementsHandle);
+			}
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vtx_size, (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)idx_size, (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+		}
 
 		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
 		{
@@ -221,7 +249,7 @@ void ImGuiWrapper::render()
 			{
 				glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
 				glScissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-				glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
+				glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (GLvoid*)idx_buffer_offset, base_vertex);
 			}
 			idx_buffer_offset += pcmd->ElemCount;
 		}
@@ -353,16 +381,10 @@ bool ImGuiWrapper::createDeviceObjects()
 
 	glGenVertexArrays(1, &mVaoHandle);
 	glBindVertexArray(mVaoHandle);
-	glBindBuffer(GL_ARRAY_BUFFER, mVboHandle);
 	glEnableVertexAttribArray(mAttribLocationPosition);
 	glEnableVertexAttribArray(mAttribLocationUV);
 	glEnableVertexAttribArray(mAttribLocationColor);
-
-#define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
-	glVertexAttribPointer(mAttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
-	glVertexAttribPointer(mAttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
-	glVertexAttribPointer(mAttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
-#undef OFFSETOF
+	bindBuffers(mVboHandle, mElementsHandle);
 
 	createFontsTexture();
 
@@ -374,6 +396,19 @@ bool ImGuiWrapper::createDeviceObjects()
 	return true;
 }
 
+void ImGuiWrapper::bindBuffers(unsigned int vertexBuffer, unsigned int indexBuffer)
+{
+	// Points the bound vertex array at the buffers the next draws read from
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+#define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
+	glVertexAttribPointer(mAttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
+	glVertexAttribPointer(mAttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
+	glVertexAttribPointer(mAttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
+#undef OFFSETOF
+}
+
 void ImGuiWrapper::invalidateDeviceObjects()
 {
 	if (mVaoHandle) glDeleteVertexArrays(1, &mVaoHandle);
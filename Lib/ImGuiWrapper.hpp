@@ -23,6 +23,7 @@ class ImGuiWrapper
 
 	private:
 		bool createDeviceObjects();
+		void bindBuffers(unsigned int vertexBuffer, unsigned int indexBuffer);
 		void invalidateDeviceObjects();
 
 		bool createFontsTexture();
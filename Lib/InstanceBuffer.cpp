@@ -0,0 +1,56 @@
+#include "InstanceBuffer.hpp"
+
+namespace cmgl
+{
+
+InstanceBuffer::InstanceBuffer()
+{
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+	destroy();
+}
+
+void InstanceBuffer::destroy()
+{
+	mBuffer.destroy();
+	mInstances.clear();
+}
+
+void InstanceBuffer::clear()
+{
+	mInstances.clear();
+}
+
+std::size_t InstanceBuffer::add(const InstanceData* instances, std::size_t count)
+{
+	const std::size_t offset = mInstances.size() * sizeof(InstanceData);
+	mInstances.insert(mInstances.end(), instances, instances + count);
+	return offset;
+}
+
+void InstanceBuffer::upload()
+{
+	if (mInstances.empty())
+	{
+		return;
+	}
+	if (mBuffer.getBuffer() == 0)
+	{
+		mBuffer.create();
+	}
+	mBuffer.upload(mInstances.data(), mInstances.size() * sizeof(InstanceData));
+}
+
+unsigned int InstanceBuffer::getBuffer() const
+{
+	return mBuffer.getBuffer();
+}
+
+std::size_t InstanceBuffer::getInstanceCount() const
+{
+	return mInstances.size();
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "StreamBuffer.hpp"
+#include "Vertex.hpp"
+
+namespace cmgl
+{
+
+// Per-instance attributes of every instanced draw in a frame, gathered in a single vertex buffer
+// add() the instances of each draw during the frame, upload() once, then pass getBuffer() and the offsets to Mesh::drawLodInstanced
+class InstanceBuffer
+{
+	public:
+		InstanceBuffer();
+		~InstanceBuffer();
+
+		InstanceBuffer(const InstanceBuffer&) = delete;
+		InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+		void destroy();
+
+		// Forgets the instances of the previous frame
+		void clear();
+
+		// Returns the byte offset of the first instance in the buffer
+		std::size_t add(const InstanceData* instances, std::size_t count);
+
+		// Sends every instance added since clear() through the upload ring
+		void upload();
+
+		unsigned int getBuffer() const;
+		std::size_t getInstanceCount() const;
+
+	private:
+		StreamBuffer mBuffer;
+		std::vector<InstanceData> mInstances;
+};
+
+} // namespace cmgl
\ No newline at end of file
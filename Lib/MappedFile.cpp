@@ -0,0 +1,147 @@
+#include "MappedFile.hpp"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cmgl
+{
+
+MappedFile::MappedFile()
+	#ifdef _WIN32
+	: mFile(INVALID_HANDLE_VALUE)
+	, mMapping(nullptr)
+	#else
+	: mFile(-1)
+	#endif
+	, mData(nullptr)
+	, mSize(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+
+	#ifdef _WIN32
+	mFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size))
+	{
+		close();
+		return false;
+	}
+	mSize = static_cast<std::size_t>(size.QuadPart);
+	if (mSize > 0)
+	{
+		mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mMapping == nullptr)
+		{
+			close();
+			return false;
+		}
+		mData = static_cast<const unsigned char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+		if (mData == nullptr)
+		{
+			close();
+			return false;
+		}
+	}
+	#else
+	mFile = ::open(filename.c_str(), O_RDONLY);
+	if (mFile == -1)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(mFile, &info) != 0)
+	{
+		close();
+		return false;
+	}
+	mSize = static_cast<std::size_t>(info.st_size);
+	if (mSize > 0)
+	{
+		void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+		if (data == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+		madvise(data, mSize, MADV_SEQUENTIAL);
+		mData = static_cast<const unsigned char*>(data);
+	}
+	#endif
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	#ifdef _WIN32
+	if (mData != nullptr)
+	{
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping != nullptr)
+	{
+		CloseHandle(mMapping);
+		mMapping = nullptr;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	#else
+	if (mData != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(mData), mSize);
+	}
+	if (mFile != -1)
+	{
+		::close(mFile);
+		mFile = -1;
+	}
+	#endif
+	mData = nullptr;
+	mSize = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+	#ifdef _WIN32
+	return mFile != INVALID_HANDLE_VALUE;
+	#else
+	return mFile != -1;
+	#endif
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return mData;
+}
+
+std::size_t MappedFile::getSize() const
+{
+	return mSize;
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace cmgl
+{
+
+class MappedFile
+{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const std::string& filename);
+		void close();
+		bool isOpen() const;
+
+		const unsigned char* getData() const;
+		std::size_t getSize() const;
+
+	private:
+		#ifdef _WIN32
+		void* mFile;
+		void* mMapping;
+		#else
+		int mFile;
+		#endif
+		const unsigned char* mData;
+		std::size_t mSize;
+};
+
+} // namespace cmgl
\ No newline at end of file
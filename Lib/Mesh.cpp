@@ -2,97 +2,1126 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <assimp/mesh.h>
 
+#include "Bounds.hpp"
+#include "MeshCache.hpp"
+#include "MeshCodec.hpp"
+#include "MeshOptimizer.hpp"
+#include "ObjLoader.hpp"
+#include "StateCache.hpp"
+#include "UploadRing.hpp"
+
 namespace cmgl
 {
 
+namespace priv
+{
+	// 0 is kept for no mesh
+	std::atomic<unsigned int> next_mesh_sort_id(1);
+
+	typedef std::size_t(*VertexCompaction)(Vertex*, std::size_t, unsigned int*, std::size_t);
+
+	// Layout of the Bounds cache section
+	struct CachedBounds
+	{
+		BoundingBox box;
+		BoundingSphere sphere;
+	};
+
+	// Tolerance of WeldNearVertices : catches the float noise exporters leave on duplicated vertices
+	const float mesh_weld_epsilon = 1e-5f;
+
+	std::size_t weld_exact(Vertex* vertices, std::size_t vertexCount, unsigned int* indices, std::size_t indexCount)
+	{
+		return weldVertices(vertices, vertexCount, indices, indexCount);
+	}
+
+	std::size_t weld_near(Vertex* vertices, std::size_t vertexCount, unsigned int* indices, std::size_t indexCount)
+	{
+		return weldVertices(vertices, vertexCount, indices, indexCount, mesh_weld_epsilon);
+	}
+
+	// Runs a stage that shrinks the vertex ranges of the sub-meshes, then packs the ranges back together
+	void compact_sub_meshes(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Mesh::SubMesh>& subMeshes, std::vector<unsigned int>& vertexCounts, VertexCompaction compaction)
+	{
+		unsigned int baseVertex = 0;
+		for (std::size_t i = 0; i < subMeshes.size(); i++)
+		{
+			Vertex* range = vertices.data() + subMeshes[i].baseVertex;
+			const std::size_t count = compaction(range, vertexCounts[i], indices.data() + subMeshes[i].indexOffset, subMeshes[i].indexCount);
+			std::memmove(vertices.data() + baseVertex, range, sizeof(Vertex) * count);
+			subMeshes[i].baseVertex = baseVertex;
+			vertexCounts[i] = (unsigned int)count;
+			baseVertex += (unsigned int)count;
+		}
+		vertices.resize(baseVertex);
+	}
+
+	unsigned int count_vertex_transforms(const std::vector<unsigned int>& indices, const std::vector<Mesh::SubMesh>& subMeshes, const std::vector<unsigned int>& vertexCounts)
+	{
+		unsigned int transforms = 0;
+		for (std::size_t i = 0; i < subMeshes.size(); i++)
+		{
+			transforms += analyzeVertexCache(indices.data() + subMeshes[i].indexOffset, subMeshes[i].indexCount, vertexCounts[i]).transforms;
+		}
+		return transforms;
+	}
+
+	float measure_overdraw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Mesh::SubMesh>& subMeshes, const std::vector<unsigned int>& vertexCounts)
+	{
+		unsigned int covered = 0;
+		unsigned int shaded = 0;
+		for (std::size_t i = 0; i < subMeshes.size(); i++)
+		{
+			const OverdrawStatistics statistics = analyzeOverdraw(indices.data() + subMeshes[i].indexOffset, subMeshes[i].indexCount, vertices.data() + subMeshes[i].baseVertex, vertexCounts[i]);
+			covered += statistics.pixelsCovered;
+			shaded += statistics.pixelsShaded;
+		}
+		return (covered > 0) ? (float)shaded / (float)covered : 0.0f;
+	}
+
+	// Splits sub-meshes so every draw range references a vertex span that 16-bit indices can address
+	// Works best after OptimizeVertexFetch, when consecutive triangles reference nearby vertices
+	void split_sub_meshes(std::vector<unsigned int>& indices, std::vector<Mesh::SubMesh>& subMeshes)
+	{
+		const unsigned int maxSpan = 0xFFFF;
+		std::vector<Mesh::SubMesh> result;
+		result.reserve(subMeshes.size());
+		for (std::size_t i = 0; i < subMeshes.size(); i++)
+		{
+			const Mesh::SubMesh& subMesh = subMeshes[i];
+			unsigned int* begin = indices.data() + subMesh.indexOffset;
+			unsigned int chunkStart = 0;
+			unsigned int chunkMin = ~0u;
+			unsigned int chunkMax = 0;
+			for (unsigned int t = 0; t <= subMesh.indexCount; t += 3)
+			{
+				unsigned int triangleMin = ~0u;
+				unsigned int triangleMax = 0;
+				if (t < subMesh.indexCount)
+				{
+					triangleMin = std::min(begin[t], std::min(begin[t + 1], begin[t + 2]));
+					triangleMax = std::max(begin[t], std::max(begin[t + 1], begin[t + 2]));
+				}
+
+				const bool last = (t == subMesh.indexCount);
+				if ((last || std::max(chunkMax, triangleMax) - std::min(chunkMin, triangleMin) > maxSpan) && t > chunkStart)
+				{
+					Mesh::SubMesh chunk = subMesh;
+					chunk.indexOffset = subMesh.indexOffset + chunkStart;
+					chunk.indexCount = t - chunkStart;
+					chunk.baseVertex = subMesh.baseVertex + chunkMin;
+					for (unsigned int j = chunkStart; j < t; j++)
+					{
+						begin[j] -= chunkMin;
+					}
+					result.push_back(chunk);
+
+					chunkStart = t;
+					chunkMin = ~0u;
+					chunkMax = 0;
+				}
+				chunkMin = std::min(chunkMin, triangleMin);
+				chunkMax = std::max(chunkMax, triangleMax);
+			}
+		}
+		subMeshes.swap(result);
+	}
+
+	// Narrows the indices to 16 bits when every sub-mesh addresses fewer than 65536 vertices
+	bool narrow_indices(const unsigned int* indices, std::size_t indexCount, const Mesh::SubMesh* subMeshes, std::size_t subMeshCount, std::vector<unsigned short>& output)
+	{
+		for (std::size_t i = 0; i < subMeshCount; i++)
+		{
+			const unsigned int* begin = indices + subMeshes[i].indexOffset;
+			for (unsigned int j = 0; j < subMeshes[i].indexCount; j++)
+			{
+				if (begin[j] > 0xFFFF)
+				{
+					return false;
+				}
+			}
+		}
+		output.assign(indices, indices + indexCount);
+		return true;
+	}
+
+	bool is_meshlet_visible(const Meshlet& meshlet, const glm::vec4 planes[6], const glm::vec3& camera)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const glm::vec3 normal(planes[i]);
+			if (glm::dot(normal, meshlet.center) + planes[i].w < -meshlet.radius * glm::length(normal))
+			{
+				return false;
+			}
+		}
+		const glm::vec3 direction = meshlet.center - camera;
+		return glm::dot(direction, meshlet.coneAxis) < meshlet.coneCutoff * glm::length(direction) + meshlet.radius;
+	}
+
+	bool is_obj_file(const std::string& filename)
+	{
+		if (filename.size() < 4)
+		{
+			return false;
+		}
+		std::string extension = filename.substr(filename.size() - 4);
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		return extension == ".obj";
+	}
+
+	bool import_assimp(const std::string& filename, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Mesh::SubMesh>& subMeshes)
+	{
+		vertices.clear();
+		indices.clear();
+		subMeshes.clear();
+
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(filename, aiProcessPreset_TargetRealtime_Fast & ~aiProcess_CalcTangentSpace);
+		if (!scene)
+		{
+			printf("Error : %s\n", importer.GetErrorString());
+			return false;
+		}
+
+		for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+		{
+			const aiMesh* mesh = scene->mMeshes[m];
+			if ((mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) == 0)
+			{
+				continue;
+			}
+
+			Mesh::SubMesh subMesh;
+			subMesh.indexOffset = (unsigned int)indices.size();
+			subMesh.baseVertex = (unsigned int)vertices.size();
+			subMesh.materialIndex = mesh->mMaterialIndex;
+
+			const bool hasUV = mesh->HasTextureCoords(0);
+			const bool hasNormals = mesh->HasNormals();
+			vertices.reserve(vertices.size() + mesh->mNumVertices);
+			for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+			{
+				glm::vec3 pos;
+				glm::vec2 uv;
+				glm::vec3 normal(0.0f, 1.0f, 0.0f);
+				memcpy(&pos, &mesh->mVertices[i], 3 * sizeof(float));
+				if (hasUV)
+				{
+					memcpy(&uv, &mesh->mTextureCoords[0][i], 2 * sizeof(float));
+				}
+				if (hasNormals)
+				{
+					memcpy(&normal, &mesh->mNormals[i], 3 * sizeof(float));
+				}
+				vertices.push_back(Vertex(pos, uv, normal));
+			}
+
+			// Indices stay local to the sub-mesh, the draw adds baseVertex
+			indices.reserve(indices.size() + 3 * mesh->mNumFaces);
+			for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+			{
+				if (mesh->mFaces[i].mNumIndices == 3)
+				{
+					indices.push_back(mesh->mFaces[i].mIndices[0]);
+					indices.push_back(mesh->mFaces[i].mIndices[1]);
+					indices.push_back(mesh->mFaces[i].mIndices[2]);
+				}
+			}
+
+			subMesh.indexCount = (unsigned int)indices.size() - subMesh.indexOffset;
+			subMeshes.push_back(subMesh);
+		}
+		return true;
+	}
+
+	const std::size_t lod_max_count = 5;
+	const float lod_max_error = 0.05f;
+
+	// Each level halves the previous one, its ranges are appended after the previous levels and reuse the same vertices
+	// Stops when the simplifier can no longer remove 15% of the triangles within the error budget
+	// Levels are reordered for the vertex cache like level 0, under the same import flags
+	void generate_lods(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Mesh::SubMesh>& subMeshes, std::vector<Mesh::Lod>& lods, unsigned int flags)
+	{
+		std::vector<unsigned int> lodIndices;
+		while (lods.size() < lod_max_count)
+		{
+			const Mesh::Lod previous = lods.back();
+			Mesh::Lod lod;
+			lod.subMeshOffset = (unsigned int)subMeshes.size();
+			lod.subMeshCount = previous.subMeshCount;
+			lod.error = previous.error;
+
+			std::size_t before = 0;
+			std::size_t after = 0;
+			for (unsigned int s = 0; s < previous.subMeshCount; s++)
+			{
+				Mesh::SubMesh subMesh = subMeshes[previous.subMeshOffset + s];
+				const unsigned int* source = indices.data() + subMesh.indexOffset;
+				std::size_t vertexCount = 0;
+				for (unsigned int i = 0; i < subMesh.indexCount; i++)
+				{
+					vertexCount = std::max<std::size_t>(vertexCount, source[i] + 1);
+				}
+				const Vertex* subVertices = vertices.data() + subMesh.baseVertex;
+
+				glm::vec3 minimum(0.0f);
+				glm::vec3 maximum(0.0f);
+				if (vertexCount > 0)
+				{
+					minimum = maximum = subVertices[0].position;
+				}
+				for (std::size_t i = 1; i < vertexCount; i++)
+				{
+					minimum = glm::min(minimum, subVertices[i].position);
+					maximum = glm::max(maximum, subVertices[i].position);
+				}
+				const glm::vec3 size = maximum - minimum;
+
+				float error = 0.0f;
+				lodIndices.resize(subMesh.indexCount);
+				const std::size_t count = simplifyMesh(lodIndices.data(), source, subMesh.indexCount, subVertices, vertexCount, (subMesh.indexCount / 6) * 3, lod_max_error, &error);
+				if ((flags & (Mesh::OptimizeVertexCache | Mesh::OptimizeOverdraw)) != 0)
+				{
+					optimizeVertexCache(lodIndices.data(), count, vertexCount);
+				}
+				lod.error = std::max(lod.error, previous.error + error * std::max(size.x, std::max(size.y, size.z)));
+
+				before += subMesh.indexCount;
+				after += count;
+				subMesh.indexOffset = (unsigned int)indices.size();
+				subMesh.indexCount = (unsigned int)count;
+				indices.insert(indices.end(), lodIndices.begin(), lodIndices.begin() + count);
+				subMeshes.push_back(subMesh);
+			}
+
+			if (after == 0 || after > before - before / 7)
+			{
+				indices.resize(subMeshes[lod.subMeshOffset].indexOffset);
+				subMeshes.resize(lod.subMeshOffset);
+				break;
+			}
+			lods.push_back(lod);
+		}
+	}
+
+	// Sub-mesh indices are rebased to the shared vertex buffer so that vertices used by several draw ranges get a single frame
+	void generate_tangents(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Mesh::SubMesh>& subMeshes, std::vector<PackedTangent>& tangents)
+	{
+		std::vector<unsigned int> globalIndices;
+		globalIndices.reserve(indices.size());
+		for (std::size_t i = 0; i < subMeshes.size(); i++)
+		{
+			for (unsigned int j = 0; j < subMeshes[i].indexCount; j++)
+			{
+				globalIndices.push_back(indices[subMeshes[i].indexOffset + j] + subMeshes[i].baseVertex);
+			}
+		}
+
+		std::vector<glm::vec4> frames(vertices.size());
+		generateTangents(globalIndices.data(), globalIndices.size(), vertices.data(), vertices.size(), frames.data());
+		tangents.resize(vertices.size());
+		for (std::size_t i = 0; i < vertices.size(); i++)
+		{
+			tangents[i] = PackedTangent(frames[i]);
+		}
+	}
+
+	// Import stages, in order : welding, triangle order (vertex cache then overdraw), vertex fetch order
+	// Every stage works per sub-mesh on local indices
+	void optimize_mesh(const std::string& filename, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Mesh::SubMesh>& subMeshes, unsigned int flags, Mesh::Statistics& statistics)
+	{
+		std::memset(&statistics, 0, sizeof(statistics));
+		statistics.verticesBefore = (unsigned int)vertices.size();
+
+		std::vector<unsigned int> vertexCounts(subMeshes.size());
+		for (std::size_t i = 0; i < subMeshes.size(); i++)
+		{
+			const unsigned int end = (i + 1 < subMeshes.size()) ? subMeshes[i + 1].baseVertex : (unsigned int)vertices.size();
+			vertexCounts[i] = end - subMeshes[i].baseVertex;
+		}
+
+		if ((flags & Mesh::WeldNearVertices) != 0)
+		{
+			compact_sub_meshes(vertices, indices, subMeshes, vertexCounts, weld_near);
+		}
+		else if ((flags & Mesh::WeldVertices) != 0)
+		{
+			compact_sub_meshes(vertices, indices, subMeshes, vertexCounts, weld_exact);
+		}
+
+		const unsigned int transformsBefore = count_vertex_transforms(indices, subMeshes, vertexCounts);
+		if ((flags & Mesh::OptimizeOverdraw) != 0)
+		{
+			statistics.overdrawBefore = measure_overdraw(vertices, indices, subMeshes, vertexCounts);
+		}
+		if ((flags & (Mesh::OptimizeVertexCache | Mesh::OptimizeOverdraw)) != 0)
+		{
+			for (std::size_t i = 0; i < subMeshes.size(); i++)
+			{
+				optimizeVertexCache(indices.data() + subMeshes[i].indexOffset, subMeshes[i].indexCount, vertexCounts[i]);
+			}
+		}
+		if ((flags & Mesh::OptimizeOverdraw) != 0)
+		{
+			for (std::size_t i = 0; i < subMeshes.size(); i++)
+			{
+				optimizeOverdraw(indices.data() + subMeshes[i].indexOffset, subMeshes[i].indexCount, vertices.data() + subMeshes[i].baseVertex, vertexCounts[i]);
+			}
+			statistics.overdrawAfter = measure_overdraw(vertices, indices, subMeshes, vertexCounts);
+		}
+		const unsigned int transformsAfter = count_vertex_transforms(indices, subMeshes, vertexCounts);
+
+		if ((flags & Mesh::OptimizeVertexFetch) != 0)
+		{
+			compact_sub_meshes(vertices, indices, subMeshes, vertexCounts, optimizeVertexFetch);
+		}
+		statistics.verticesAfter = (unsigned int)vertices.size();
+
+		if ((flags & Mesh::SplitIndexBuffers) != 0)
+		{
+			split_sub_meshes(indices, subMeshes);
+		}
+
+		if (!indices.empty() && !vertices.empty())
+		{
+			statistics.acmrBefore = (float)transformsBefore / (float)(indices.size() / 3);
+			statistics.acmrAfter = (float)transformsAfter / (float)(indices.size() / 3);
+			statistics.atvrBefore = (float)transformsBefore / (float)statistics.verticesBefore;
+			statistics.atvrAfter = (float)transformsAfter / (float)statistics.verticesAfter;
+		}
+		printf("Mesh %s : %u -> %u vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", filename.c_str(), statistics.verticesBefore, statistics.verticesAfter, statistics.acmrBefore, statistics.acmrAfter, statistics.atvrBefore, statistics.atvrAfter);
+	}
+
+	// Level 0 of the prepared data, read from the same arrays or cache sections as the upload
+	void copy_base_level(const Mesh::Data& data, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+	{
+		const unsigned char* vertexBytes = static_cast<const unsigned char*>(data.vertexData);
+		vertices.resize(data.vertexCount);
+		for (std::size_t i = 0; i < data.vertexCount; i++)
+		{
+			if (data.quantized)
+			{
+				PackedVertex vertex;
+				std::memcpy(&vertex, vertexBytes + i * sizeof(PackedVertex), sizeof(PackedVertex));
+				vertices[i] = vertex.unpack(data.positionOffset, data.positionScale);
+			}
+			else
+			{
+				std::memcpy(&vertices[i], vertexBytes + i * sizeof(Vertex), sizeof(Vertex));
+			}
+		}
+
+		indices.clear();
+		const std::size_t first = data.lods.empty() ? 0 : data.lods[0].subMeshOffset;
+		const std::size_t last = data.lods.empty() ? data.subMeshes.size() : first + data.lods[0].subMeshCount;
+		for (std::size_t s = first; s < last; s++)
+		{
+			const Mesh::SubMesh& subMesh = data.subMeshes[s];
+			for (unsigned int i = subMesh.indexOffset; i < subMesh.indexOffset + subMesh.indexCount; i++)
+			{
+				const unsigned int index = (data.indexSize == sizeof(unsigned short)) ? static_cast<const unsigned short*>(data.indexData)[i] : static_cast<const unsigned int*>(data.indexData)[i];
+				indices.push_back(index + subMesh.baseVertex);
+			}
+		}
+	}
+}
+
+Mesh::Data::Data()
+	: vertexData(nullptr)
+	, tangentData(nullptr)
+	, indexData(nullptr)
+	, vertexCount(0)
+	, indexCount(0)
+	, indexSize(0)
+	, format(getVertexFormat<Vertex>())
+	, quantized(false)
+	, positionOffset(0.0f)
+	, positionScale(1.0f)
+	, keepGeometry(false)
+{
+	std::memset(&statistics, 0, sizeof(statistics));
+	boundingBox.min = glm::vec3(0.0f);
+	boundingBox.max = glm::vec3(0.0f);
+	boundingSphere.center = glm::vec3(0.0f);
+	boundingSphere.radius = 0.0f;
+}
+
 Mesh::Mesh()
 {
-	mBuffers[0] = 0;
-	mBuffers[1] = 0;
+	for (std::size_t i = 0; i < GeometryArena::PoolCount; i++)
+	{
+		mAllocations[i] = 0;
+	}
+	mGeneration = 0;
+	mSortId = priv::next_mesh_sort_id++;
+	mIndexOffset = 0;
+	mVertexArray = 0;
+	mVertices = 0;
+	mIndexType = GL_UNSIGNED_INT;
+	mFormat = getVertexFormat<Vertex>();
+	std::memset(&mStatistics, 0, sizeof(mStatistics));
+	mQuantized = false;
+	mPositionOffset = glm::vec3(0.0f);
+	mPositionScale = glm::vec3(1.0f);
+	mBoundingBox.min = glm::vec3(0.0f);
+	mBoundingBox.max = glm::vec3(0.0f);
+	mBoundingSphere.center = glm::vec3(0.0f);
+	mBoundingSphere.radius = 0.0f;
 }
 
 Mesh::~Mesh()
 {
-	if (isValid())
+	release();
+	if (mVertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &mVertexArray);
+		StateCache::getDefault().forgetVertexArray(mVertexArray);
+	}
+}
+
+bool Mesh::loadFromFile(const std::string& filename, unsigned int flags)
+{
+	Data data;
+	if (!loadDataFromFile(filename, flags, data))
 	{
-		glDeleteBuffers(2, mBuffers);
+		setState(Failed);
+		return false;
 	}
+	return loadFromData(data);
 }
 
-bool Mesh::loadFromFile(const std::string& filename)
+bool Mesh::loadDataFromFile(const std::string& filename, unsigned int flags, Data& data)
 {
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(filename, aiProcessPreset_TargetRealtime_Fast);
-	if (!scene)
+	// Only loadFromData reads it, the cache is shared with loads that do not keep the geometry
+	data.keepGeometry = ((flags & KeepGeometry) != 0);
+	flags &= ~KeepGeometry;
+
+	std::uint64_t sourceHash = 0;
+	if (!MeshCache::computeFileHash(filename, sourceHash))
 	{
-		printf("Error : %s\n", importer.GetErrorString());
+		fprintf(stderr, "Failed to open mesh : %s\n", filename.c_str());
 		return false;
 	}
 
-	aiMesh* mesh = scene->mMeshes[0];
+	const std::string cacheFilename = MeshCache::getCacheFilename(filename);
+	if (data.cache.loadFromFile(cacheFilename, sourceHash) && loadDataFromCache(data, flags))
+	{
+		return true;
+	}
 
-	std::vector<Vertex> vertices;
-	vertices.reserve(mesh->mNumVertices);
-	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+	// OBJ files skip Assimp, which stays the fallback for everything the native reader rejects
+	std::vector<Vertex>& vertices = data.vertices;
+	std::vector<unsigned int>& indices = data.indices;
+	std::vector<SubMesh>& subMeshes = data.subMeshes;
+	if (!priv::is_obj_file(filename) || !loadObj(filename, vertices, indices, subMeshes))
 	{
-		glm::vec3 pos;
-		glm::vec2 uv;
-		glm::vec3 normal;
-		memcpy(&pos, &mesh->mVertices[i], 3 * sizeof(float));
-		memcpy(&uv, &mesh->mTextureCoords[0][i], 2 * sizeof(float));
-		memcpy(&normal, &mesh->mNormals[i], 3 * sizeof(float));
-		vertices.push_back(Vertex(pos, uv, normal));
+		if (!priv::import_assimp(filename, vertices, indices, subMeshes))
+		{
+			return false;
+		}
 	}
 
-	std::vector<unsigned int> indices;
-	indices.reserve(3 * mesh->mNumFaces);
-	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	priv::optimize_mesh(filename, vertices, indices, subMeshes, flags, data.statistics);
+
+	// Generated before the levels of detail are appended, which only reference existing vertices
+	if ((flags & GenerateTangents) != 0)
 	{
-		indices.push_back(mesh->mFaces[i].mIndices[0]);
-		indices.push_back(mesh->mFaces[i].mIndices[1]);
-		indices.push_back(mesh->mFaces[i].mIndices[2]);
+		priv::generate_tangents(vertices, indices, subMeshes, data.tangents);
+		data.tangentData = data.tangents.data();
 	}
-	mVertices = 3 * mesh->mNumFaces;
 
-	glGenBuffers(2, mBuffers);
+	// Level of detail vertices are a subset of the full ones, the bounds cover every level
+	data.boundingBox = computeBoundingBox(vertices.data(), vertices.size());
+	data.boundingSphere = computeBoundingSphere(vertices.data(), vertices.size());
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mBuffers[0]);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), &indices[0], GL_STATIC_DRAW);
+	std::vector<Lod>& lods = data.lods;
+	lods.resize(1);
+	lods[0].subMeshOffset = 0;
+	lods[0].subMeshCount = (unsigned int)subMeshes.size();
+	lods[0].error = 0.0f;
+	if ((flags & GenerateLods) != 0)
+	{
+		priv::generate_lods(vertices, indices, subMeshes, lods, flags);
+	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, mBuffers[1]);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+	// Meshlets are cut last, from the final triangle order and draw ranges of the full detail level
+	std::vector<Meshlet>& meshlets = data.meshlets;
+	if ((flags & BuildMeshlets) != 0)
+	{
+		for (std::size_t i = 0; i < lods[0].subMeshCount; i++)
+		{
+			const SubMesh& subMesh = subMeshes[i];
+			const std::size_t first = meshlets.size();
+			buildMeshlets(indices.data() + subMesh.indexOffset, subMesh.indexCount, vertices.data() + subMesh.baseVertex, vertices.size() - subMesh.baseVertex, meshlets);
+			for (std::size_t j = first; j < meshlets.size(); j++)
+			{
+				meshlets[j].indexOffset += subMesh.indexOffset;
+				meshlets[j].baseVertex = subMesh.baseVertex;
+				meshlets[j].subMesh = (unsigned int)i;
+			}
+		}
+	}
 
+	// Quantize against the box of the whole mesh so every sub-mesh shares the same decode
+	glm::vec3 quantization[2] = { glm::vec3(0.0f), glm::vec3(1.0f) };
+	std::vector<PackedVertex>& packedVertices = data.packedVertices;
+	if ((flags & QuantizeVertices) != 0 && !vertices.empty())
+	{
+		quantization[0] = data.boundingBox.min;
+		quantization[1] = data.boundingBox.max - data.boundingBox.min;
+
+		// Decoded positions move by up to half a quantization step, keep them inside the meshlet spheres
+		const float error = glm::length(quantization[1]) / 65535.0f;
+		for (std::size_t i = 0; i < meshlets.size(); i++)
+		{
+			meshlets[i].radius += error;
+		}
+		packedVertices.reserve(vertices.size());
+		for (std::size_t i = 0; i < vertices.size(); i++)
+		{
+			packedVertices.push_back(PackedVertex(vertices[i], quantization[0], quantization[1]));
+		}
+	}
+	data.quantized = !packedVertices.empty();
+	data.vertexData = data.quantized ? (const void*)packedVertices.data() : (const void*)vertices.data();
+	data.vertexCount = vertices.size();
+	data.format = data.quantized ? getVertexFormat<PackedVertex>() : getVertexFormat<Vertex>();
+
+	const bool narrow = priv::narrow_indices(indices.data(), indices.size(), subMeshes.data(), subMeshes.size(), data.shortIndices);
+	data.indexData = narrow ? (const void*)data.shortIndices.data() : (const void*)indices.data();
+	data.indexCount = indices.size();
+	data.indexSize = narrow ? sizeof(unsigned short) : sizeof(unsigned int);
+
+	MeshCache output;
+	output.setFlags(flags);
+	output.setCounts((std::uint32_t)data.vertexCount, (std::uint32_t)data.format.stride, (std::uint32_t)data.indexCount, (std::uint32_t)data.indexSize);
+	std::vector<unsigned char> encodedVertices;
+	std::vector<unsigned char> encodedIndices;
+	std::vector<unsigned char> encodedTangents;
+	const std::size_t tangentSize = data.tangents.size() * sizeof(PackedTangent);
+	if ((flags & CompressCache) != 0)
+	{
+		if (!encodeVertexBuffer(encodedVertices, data.vertexData, data.vertexCount, data.format.stride)
+			|| !encodeIndexBuffer(encodedIndices, data.indexData, data.indexCount, data.indexSize)
+			|| (!data.tangents.empty() && !encodeVertexBuffer(encodedTangents, data.tangents.data(), data.tangents.size(), sizeof(PackedTangent))))
+		{
+			fprintf(stderr, "Mesh %s : failed to compress the cache streams\n", filename.c_str());
+			return false;
+		}
+		output.setSection(MeshCache::Vertices, encodedVertices.data(), encodedVertices.size());
+		output.setSection(MeshCache::Indices, encodedIndices.data(), encodedIndices.size());
+		output.setSection(MeshCache::Tangents, encodedTangents.empty() ? nullptr : encodedTangents.data(), encodedTangents.size());
+	}
+	else
+	{
+		output.setSection(MeshCache::Vertices, data.vertexData, data.format.stride * data.vertexCount);
+		output.setSection(MeshCache::Indices, data.indexData, data.indexSize * data.indexCount);
+		output.setSection(MeshCache::Tangents, data.tangents.empty() ? nullptr : data.tangents.data(), tangentSize);
+	}
+	output.setSection(MeshCache::SubMeshes, subMeshes.data(), sizeof(SubMesh) * subMeshes.size());
+	output.setSection(MeshCache::Statistics, &data.statistics, sizeof(Statistics));
+	output.setSection(MeshCache::Quantization, quantization, sizeof(quantization));
+	output.setSection(MeshCache::Meshlets, meshlets.data(), sizeof(Meshlet) * meshlets.size());
+	output.setSection(MeshCache::Lods, lods.data(), sizeof(Lod) * lods.size());
+	const priv::CachedBounds bounds = { data.boundingBox, data.boundingSphere };
+	output.setSection(MeshCache::Bounds, &bounds, sizeof(bounds));
+	output.saveToFile(cacheFilename, sourceHash);
+
+	data.positionOffset = quantization[0];
+	data.positionScale = quantization[1];
 	return true;
 }
 
+bool Mesh::loadFromData(const Data& data)
+{
+	mQuantized = data.quantized;
+	mPositionOffset = data.positionOffset;
+	mPositionScale = data.positionScale;
+	mMeshlets = data.meshlets;
+	if (!upload(data.vertexData, data.vertexCount, data.format, data.tangentData, data.indexData, data.indexCount, data.indexSize, data.subMeshes.data(), data.subMeshes.size()))
+	{
+		return false;
+	}
+	mLods = data.lods;
+	mBoundingBox = data.boundingBox;
+	mBoundingSphere = data.boundingSphere;
+	mStatistics = data.statistics;
+	mGeometryVertices.clear();
+	mGeometryIndices.clear();
+	if (data.keepGeometry)
+	{
+		priv::copy_base_level(data, mGeometryVertices, mGeometryIndices);
+	}
+	return true;
+}
+
+bool Mesh::loadFromMemory(const void* vertices, std::size_t vertexCount, const VertexFormat& format, const unsigned int* indices, std::size_t indexCount, const SubMesh* subMeshes, std::size_t subMeshCount)
+{
+	if (indices == nullptr || subMeshes == nullptr)
+	{
+		fprintf(stderr, "Failed to create mesh, no geometry\n");
+		setState(Failed);
+		return false;
+	}
+
+	mQuantized = false;
+	mPositionOffset = glm::vec3(0.0f);
+	mPositionScale = glm::vec3(1.0f);
+	mMeshlets.clear();
+	mBoundingBox.min = glm::vec3(0.0f);
+	mBoundingBox.max = glm::vec3(0.0f);
+	mBoundingSphere.center = glm::vec3(0.0f);
+	mBoundingSphere.radius = 0.0f;
+	mGeometryVertices.clear();
+	mGeometryIndices.clear();
+
+	std::vector<unsigned short> shortIndices;
+	if (priv::narrow_indices(indices, indexCount, subMeshes, subMeshCount, shortIndices))
+	{
+		return upload(vertices, vertexCount, format, nullptr, shortIndices.data(), indexCount, sizeof(unsigned short), subMeshes, subMeshCount);
+	}
+	return upload(vertices, vertexCount, format, nullptr, indices, indexCount, sizeof(unsigned int), subMeshes, subMeshCount);
+}
+
+bool Mesh::upload(const void* vertices, std::size_t vertexCount, const VertexFormat& format, const PackedTangent* tangents, const void* indices, std::size_t indexCount, std::size_t indexSize, const SubMesh* subMeshes, std::size_t subMeshCount)
+{
+	if (vertices == nullptr || indices == nullptr || vertexCount == 0 || indexCount == 0 || subMeshes == nullptr || subMeshCount == 0)
+	{
+		fprintf(stderr, "Failed to create mesh, no geometry\n");
+		setState(Failed);
+		return false;
+	}
+
+	// The geometry lives in ranges of the shared arena buffers, the mesh only keeps their handles
+	GeometryArena& arena = GeometryArena::getDefault();
+	release();
+	mAllocations[GeometryArena::Vertices] = arena.allocate(GeometryArena::Vertices, format.stride * vertexCount);
+	mAllocations[GeometryArena::Indices] = arena.allocate(GeometryArena::Indices, indexSize * indexCount);
+	if (tangents != nullptr)
+	{
+		// Tangents are a stream of their own so that any vertex format can be normal mapped
+		mAllocations[GeometryArena::Tangents] = arena.allocate(GeometryArena::Tangents, sizeof(PackedTangent) * vertexCount);
+	}
+	if (!isValid() || (tangents != nullptr && mAllocations[GeometryArena::Tangents] == 0))
+	{
+		fprintf(stderr, "Failed to create mesh, out of geometry memory\n");
+		release();
+		setState(Failed);
+		return false;
+	}
+
+	if (mVertexArray == 0)
+	{
+		glGenVertexArrays(1, &mVertexArray);
+	}
+	mVertices = (unsigned int)indexCount;
+	mIndexType = (indexSize == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// Copied from the upload ring once every range is allocated, so that no pool grows under a pending copy offset
+	UploadRing& ring = UploadRing::getDefault();
+	ring.copyToBuffer(arena.getBuffer(GeometryArena::Indices), arena.getOffset(GeometryArena::Indices, mAllocations[GeometryArena::Indices]), indices, indexSize * indexCount);
+	ring.copyToBuffer(arena.getBuffer(GeometryArena::Vertices), arena.getOffset(GeometryArena::Vertices, mAllocations[GeometryArena::Vertices]), vertices, format.stride * vertexCount);
+	if (tangents != nullptr)
+	{
+		ring.copyToBuffer(arena.getBuffer(GeometryArena::Tangents), arena.getOffset(GeometryArena::Tangents, mAllocations[GeometryArena::Tangents]), tangents, sizeof(PackedTangent) * vertexCount);
+	}
+
+	StateCache::getDefault().bindVertexArray(mVertexArray);
+	mFormat.disable();
+	StateCache::getDefault().bindVertexArray(0);
+	mFormat = format;
+
+	// Build the multi-draw arrays once, draw() only hands them to GL
+	mSubMeshes.assign(subMeshes, subMeshes + subMeshCount);
+	mLods.resize(1);
+	mLods[0].subMeshOffset = 0;
+	mLods[0].subMeshCount = (unsigned int)subMeshCount;
+	mLods[0].error = 0.0f;
+	mDrawCounts.resize(subMeshCount);
+	mDrawOffsets.resize(subMeshCount);
+	mDrawBaseVertices.resize(subMeshCount);
+	for (std::size_t i = 0; i < subMeshCount; i++)
+	{
+		mDrawCounts[i] = (int)mSubMeshes[i].indexCount;
+		mDrawBaseVertices[i] = (int)mSubMeshes[i].baseVertex;
+	}
+	setupVertexArray();
+
+	setState(Ready);
+	return true;
+}
+
+void Mesh::release()
+{
+	GeometryArena& arena = GeometryArena::getDefault();
+	for (std::size_t i = 0; i < GeometryArena::PoolCount; i++)
+	{
+		arena.deallocate((GeometryArena::Pool)i, mAllocations[i]);
+		mAllocations[i] = 0;
+	}
+}
+
+void Mesh::bindVertexArray()
+{
+	if (mGeneration != GeometryArena::getDefault().getGeneration())
+	{
+		setupVertexArray();
+	}
+	StateCache::getDefault().bindVertexArray(mVertexArray);
+}
+
+void Mesh::setupVertexArray()
+{
+	// The vertex array captures the index buffer and the attribute layout, attributes start at the mesh's own ranges
+	GeometryArena& arena = GeometryArena::getDefault();
+	StateCache::getDefault().bindVertexArray(mVertexArray);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.getBuffer(GeometryArena::Indices));
+	glBindBuffer(GL_ARRAY_BUFFER, arena.getBuffer(GeometryArena::Vertices));
+	mFormat.enable(arena.getOffset(GeometryArena::Vertices, mAllocations[GeometryArena::Vertices]));
+	if (mAllocations[GeometryArena::Tangents] != 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, arena.getBuffer(GeometryArena::Tangents));
+		PackedTangent::Layout::enable(arena.getOffset(GeometryArena::Tangents, mAllocations[GeometryArena::Tangents]));
+	}
+	else
+	{
+		PackedTangent::Layout::disable();
+	}
+	StateCache::getDefault().bindVertexArray(0);
+
+	// Index offsets are relative to the arena buffer, base vertices to the mesh's vertex range
+	const std::size_t indexSize = (mIndexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+	mIndexOffset = arena.getOffset(GeometryArena::Indices, mAllocations[GeometryArena::Indices]);
+	for (std::size_t i = 0; i < mSubMeshes.size(); i++)
+	{
+		mDrawOffsets[i] = (const void*)(mIndexOffset + indexSize * mSubMeshes[i].indexOffset);
+	}
+	mGeneration = arena.getGeneration();
+}
+
 void Mesh::draw()
 {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mBuffers[0]);
-	glBindBuffer(GL_ARRAY_BUFFER, mBuffers[1]);
+	drawLod(0);
+}
 
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
+void Mesh::drawLod(std::size_t level)
+{
+	const Lod& lod = mLods[level];
+	bindVertexArray();
+	glMultiDrawElementsBaseVertex(GL_TRIANGLES, mDrawCounts.data() + lod.subMeshOffset, mIndexType, mDrawOffsets.data() + lod.subMeshOffset, (GLsizei)lod.subMeshCount, mDrawBaseVertices.data() + lod.subMeshOffset);
+}
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(glm::vec3)));
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(glm::vec3) + sizeof(glm::vec2)));
+void Mesh::drawLodInstanced(std::size_t level, unsigned int instanceBuffer, std::size_t offset, std::size_t instanceCount)
+{
+	if (instanceCount == 0)
+	{
+		return;
+	}
 
-	glDrawElements(GL_TRIANGLES, mVertices, GL_UNSIGNED_INT, 0);
+	// The instance attributes are only enabled for the draw, so that the other paths keep reading the vertex ones alone
+	const Lod& lod = mLods[level];
+	bindVertexArray();
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	InstanceData::Layout::enable(offset);
+	InstanceData::Layout::setDivisor(1);
+	for (std::size_t i = lod.subMeshOffset; i < lod.subMeshOffset + lod.subMeshCount; i++)
+	{
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mDrawCounts[i], mIndexType, mDrawOffsets[i], (GLsizei)instanceCount, mDrawBaseVertices[i]);
+	}
+	InstanceData::Layout::disable();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
+std::size_t Mesh::selectLod(const glm::mat4& modelView, const glm::mat4& projection, float threshold) const
+{
+	if (mLods.size() <= 1)
+	{
+		return 0;
+	}
+
+	// Errors are in model units, the model view may scale them
+	const float scale = std::sqrt(std::max(glm::dot(glm::vec3(modelView[0]), glm::vec3(modelView[0])),
+		std::max(glm::dot(glm::vec3(modelView[1]), glm::vec3(modelView[1])), glm::dot(glm::vec3(modelView[2]), glm::vec3(modelView[2])))));
+	const float radius = mBoundingSphere.radius * scale;
+	const glm::vec4 view = modelView * glm::vec4(mBoundingSphere.center, 1.0f);
+	const float distance = std::max(-view.z - radius, 1e-4f);
+
+	// Projected size of one view unit at the closest point of the bounds, as a fraction of the viewport height
+	const float screenScale = projection[1][1] * 0.5f / distance;
+	std::size_t level = 0;
+	while (level + 1 < mLods.size() && mLods[level + 1].error * scale * screenScale <= threshold)
+	{
+		level++;
+	}
+	return level;
+}
+
+void Mesh::drawSubMesh(std::size_t index)
+{
+	bindVertexArray();
+	glDrawElementsBaseVertex(GL_TRIANGLES, mDrawCounts[index], mIndexType, (void*)mDrawOffsets[index], mDrawBaseVertices[index]);
+}
+
+void Mesh::drawSubMeshes(const std::size_t* subMeshes, std::size_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// The vertex array is bound first, it refreshes the draw offsets if the arena moved the mesh
+	bindVertexArray();
+	mVisibleCounts.clear();
+	mVisibleOffsets.clear();
+	mVisibleBaseVertices.clear();
+	for (std::size_t i = 0; i < count; i++)
+	{
+		mVisibleCounts.push_back(mDrawCounts[subMeshes[i]]);
+		mVisibleOffsets.push_back(mDrawOffsets[subMeshes[i]]);
+		mVisibleBaseVertices.push_back(mDrawBaseVertices[subMeshes[i]]);
+	}
+	glMultiDrawElementsBaseVertex(GL_TRIANGLES, mVisibleCounts.data(), mIndexType, mVisibleOffsets.data(), (GLsizei)mVisibleCounts.size(), mVisibleBaseVertices.data());
+}
+
+std::size_t Mesh::drawVisible(const glm::mat4& modelView, const glm::mat4& projection, std::size_t level)
+{
+	if (mMeshlets.empty() || level > 0)
+	{
+		drawLod(level);
+		return mLods[level].subMeshCount;
+	}
+
+	glm::vec4 planes[6];
+	extractFrustumPlanes(projection * modelView, planes);
+	const glm::vec3 camera(glm::inverse(modelView)[3]);
+
+	// Visible meshlets that follow each other in the index buffer are merged into a single range
+	bindVertexArray();
+	const std::size_t indexSize = (mIndexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+	mVisibleCounts.clear();
+	mVisibleOffsets.clear();
+	mVisibleBaseVertices.clear();
+	unsigned int rangeEnd = ~0u;
+	for (std::size_t i = 0; i < mMeshlets.size(); i++)
+	{
+		const Meshlet& meshlet = mMeshlets[i];
+		if (!priv::is_meshlet_visible(meshlet, planes, camera))
+		{
+			continue;
+		}
+		if (meshlet.indexOffset == rangeEnd && (unsigned int)mVisibleBaseVertices.back() == meshlet.baseVertex)
+		{
+			mVisibleCounts.back() += (int)meshlet.indexCount;
+		}
+		else
+		{
+			mVisibleCounts.push_back((int)meshlet.indexCount);
+			mVisibleOffsets.push_back((const void*)(mIndexOffset + indexSize * meshlet.indexOffset));
+			mVisibleBaseVertices.push_back((int)meshlet.baseVertex);
+		}
+		rangeEnd = meshlet.indexOffset + meshlet.indexCount;
+	}
+
+	if (!mVisibleCounts.empty())
+	{
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, mVisibleCounts.data(), mIndexType, mVisibleOffsets.data(), (GLsizei)mVisibleCounts.size(), mVisibleBaseVertices.data());
+	}
+	return mVisibleCounts.size();
+}
+
+std::size_t Mesh::getLodCount() const
+{
+	return mLods.size();
+}
+
+const Mesh::Lod& Mesh::getLod(std::size_t level) const
+{
+	return mLods[level];
+}
+
+std::size_t Mesh::getMeshletCount() const
+{
+	return mMeshlets.size();
+}
+
+const Meshlet& Mesh::getMeshlet(std::size_t index) const
+{
+	return mMeshlets[index];
+}
+
+std::size_t Mesh::getSubMeshCount() const
+{
+	return mLods.empty() ? 0 : mLods[0].subMeshCount;
+}
+
+const Mesh::SubMesh& Mesh::getSubMesh(std::size_t index) const
+{
+	return mSubMeshes[index];
+}
+
+const Mesh::Statistics& Mesh::getStatistics() const
+{
+	return mStatistics;
+}
+
+const BoundingBox& Mesh::getBoundingBox() const
+{
+	return mBoundingBox;
+}
+
+const BoundingSphere& Mesh::getBoundingSphere() const
+{
+	return mBoundingSphere;
+}
+
+bool Mesh::hasTangents() const
+{
+	return mAllocations[GeometryArena::Tangents] != 0;
+}
+
+bool Mesh::isQuantized() const
+{
+	return mQuantized;
+}
+
+const glm::vec3& Mesh::getPositionOffset() const
+{
+	return mPositionOffset;
+}
+
+const glm::vec3& Mesh::getPositionScale() const
+{
+	return mPositionScale;
 }
 
 bool Mesh::isValid() const
 {
-	return glIsBuffer(mBuffers[0]) == GL_TRUE && glIsBuffer(mBuffers[1]) == GL_TRUE;
+	return mAllocations[GeometryArena::Vertices] != 0 && mAllocations[GeometryArena::Indices] != 0;
+}
+
+unsigned int Mesh::getSortId() const
+{
+	return mSortId;
+}
+
+bool Mesh::hasGeometry() const
+{
+	return !mGeometryIndices.empty();
+}
+
+const std::vector<Vertex>& Mesh::getGeometryVertices() const
+{
+	return mGeometryVertices;
+}
+
+const std::vector<unsigned int>& Mesh::getGeometryIndices() const
+{
+	return mGeometryIndices;
+}
+
+bool Mesh::loadDataFromCache(Data& data, unsigned int flags)
+{
+	const MeshCache& cache = data.cache;
+	const MeshCache::Header& header = cache.getHeader();
+	const VertexFormat format = ((flags & QuantizeVertices) != 0) ? getVertexFormat<PackedVertex>() : getVertexFormat<Vertex>();
+	const bool compressed = ((flags & CompressCache) != 0);
+	if (header.flags != flags || header.vertexSize != format.stride || (header.indexSize != sizeof(unsigned short) && header.indexSize != sizeof(unsigned int))
+		|| (!compressed && cache.getSectionSize(MeshCache::Vertices) != (std::size_t)header.vertexCount * header.vertexSize)
+		|| (!compressed && cache.getSectionSize(MeshCache::Indices) != (std::size_t)header.indexCount * header.indexSize)
+		|| cache.getSectionSize(MeshCache::SubMeshes) % sizeof(SubMesh) != 0
+		|| cache.getSectionSize(MeshCache::Statistics) != sizeof(Statistics)
+		|| cache.getSectionSize(MeshCache::Quantization) != 2 * sizeof(glm::vec3)
+		|| cache.getSectionSize(MeshCache::Meshlets) % sizeof(Meshlet) != 0
+		|| cache.getSectionSize(MeshCache::Lods) == 0 || cache.getSectionSize(MeshCache::Lods) % sizeof(Lod) != 0
+		|| cache.getSectionSize(MeshCache::Bounds) != sizeof(priv::CachedBounds)
+		|| ((flags & GenerateTangents) != 0) != (cache.getSectionSize(MeshCache::Tangents) > 0)
+		|| (!compressed && cache.getSectionSize(MeshCache::Tangents) > 0 && cache.getSectionSize(MeshCache::Tangents) != (std::size_t)header.vertexCount * sizeof(PackedTangent)))
+	{
+		return false;
+	}
+
+	const glm::vec3* quantization = static_cast<const glm::vec3*>(cache.getSection(MeshCache::Quantization));
+	data.quantized = ((flags & QuantizeVertices) != 0);
+	data.positionOffset = quantization[0];
+	data.positionScale = quantization[1];
+
+	// Raw sections point straight into the mapped file : no parsing and no intermediate copy
+	data.vertexData = cache.getSection(MeshCache::Vertices);
+	data.vertexCount = header.vertexCount;
+	data.format = format;
+	data.indexData = cache.getSection(MeshCache::Indices);
+	data.indexCount = header.indexCount;
+	data.indexSize = header.indexSize;
+	data.tangentData = static_cast<const PackedTangent*>(cache.getSection(MeshCache::Tangents));
+	if (compressed)
+	{
+		void* vertices = nullptr;
+		if (data.quantized)
+		{
+			data.packedVertices.resize(data.vertexCount);
+			vertices = data.packedVertices.data();
+		}
+		else
+		{
+			data.vertices.resize(data.vertexCount);
+			vertices = data.vertices.data();
+		}
+		void* indices = nullptr;
+		if (data.indexSize == sizeof(unsigned short))
+		{
+			data.shortIndices.resize(data.indexCount);
+			indices = data.shortIndices.data();
+		}
+		else
+		{
+			data.indices.resize(data.indexCount);
+			indices = data.indices.data();
+		}
+		if (!decodeVertexBuffer(vertices, data.vertexCount, data.format.stride, static_cast<const unsigned char*>(cache.getSection(MeshCache::Vertices)), cache.getSectionSize(MeshCache::Vertices))
+			|| !decodeIndexBuffer(indices, data.indexCount, data.indexSize, static_cast<const unsigned char*>(cache.getSection(MeshCache::Indices)), cache.getSectionSize(MeshCache::Indices)))
+		{
+			fprintf(stderr, "Failed to decode the compressed mesh cache\n");
+			return false;
+		}
+		data.vertexData = vertices;
+		data.indexData = indices;
+
+		if (data.tangentData != nullptr)
+		{
+			data.tangents.resize(data.vertexCount);
+			if (!decodeVertexBuffer(data.tangents.data(), data.vertexCount, sizeof(PackedTangent), static_cast<const unsigned char*>(cache.getSection(MeshCache::Tangents)), cache.getSectionSize(MeshCache::Tangents)))
+			{
+				fprintf(stderr, "Failed to decode the compressed mesh cache\n");
+				return false;
+			}
+			data.tangentData = data.tangents.data();
+		}
+	}
+	const SubMesh* subMeshes = static_cast<const SubMesh*>(cache.getSection(MeshCache::SubMeshes));
+	data.subMeshes.assign(subMeshes, subMeshes + cache.getSectionSize(MeshCache::SubMeshes) / sizeof(SubMesh));
+	std::memcpy(&data.statistics, cache.getSection(MeshCache::Statistics), sizeof(Statistics));
+	const Meshlet* meshlets = static_cast<const Meshlet*>(cache.getSection(MeshCache::Meshlets));
+	data.meshlets.assign(meshlets, meshlets + cache.getSectionSize(MeshCache::Meshlets) / sizeof(Meshlet));
+	const Lod* lods = static_cast<const Lod*>(cache.getSection(MeshCache::Lods));
+	data.lods.assign(lods, lods + cache.getSectionSize(MeshCache::Lods) / sizeof(Lod));
+	priv::CachedBounds bounds;
+	std::memcpy(&bounds, cache.getSection(MeshCache::Bounds), sizeof(bounds));
+	data.boundingBox = bounds.box;
+	data.boundingSphere = bounds.sphere;
+	return true;
 }
 
 } // namespace cmgl
\ No newline at end of file
@@ -3,26 +3,210 @@
 #include <string>
 #include <vector>
 
+#include "Bounds.hpp"
+#include "GeometryArena.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "Resource.hpp"
+#include "SubMesh.hpp"
 #include "Vertex.hpp"
+#include "VertexFormat.hpp"
 
 namespace cmgl
 {
 
-class Mesh
+class Mesh : public Resource
 {
+	public:
+		enum ImportFlags
+		{
+			None = 0,
+			OptimizeVertexCache = 1 << 0,
+			OptimizeOverdraw = 1 << 1, // Implies OptimizeVertexCache
+			WeldVertices = 1 << 2,
+			OptimizeVertexFetch = 1 << 3,
+			SplitIndexBuffers = 1 << 4, // Splits parts with 65536+ vertices into 16-bit addressable draw ranges
+			QuantizeVertices = 1 << 5, // Stores PackedVertex instead of Vertex, decoded by the vertex shader
+			BuildMeshlets = 1 << 6, // Cuts every part into meshlets that drawVisible() culls on the CPU
+			GenerateLods = 1 << 7, // Appends simplified levels of detail to the index buffer
+			CompressCache = 1 << 8, // Stores the cached vertices and indices through MeshCodec, decoded on load
+			GenerateTangents = 1 << 9, // Adds a PackedTangent stream bound to attribute 3, for normal mapping
+			WeldNearVertices = 1 << 10, // Implies WeldVertices, also merges vertices whose attributes all differ by at most 1e-5
+			KeepGeometry = 1 << 11 // Keeps level 0 on the CPU for getGeometryVertices() and getGeometryIndices(), static batches bake from it
+		};
+
+		typedef cmgl::SubMesh SubMesh;
+
+		// A level of detail is a set of draw ranges into the shared vertex buffer, level 0 is the full detail mesh
+		struct Lod
+		{
+			unsigned int subMeshOffset;
+			unsigned int subMeshCount;
+			float error; // geometric deviation from level 0, in model units
+		};
+
+		struct Statistics
+		{
+			unsigned int verticesBefore;
+			unsigned int verticesAfter;
+			float acmrBefore;
+			float acmrAfter;
+			float atvrBefore;
+			float atvrAfter;
+			float overdrawBefore;
+			float overdrawAfter;
+		};
+
+		// Everything loadFromFile prepares before touching GL, vertices and indices point either into the owned arrays or into the mapped cache
+		struct Data
+		{
+			Data();
+
+			MeshCache cache;
+			std::vector<Vertex> vertices;
+			std::vector<PackedVertex> packedVertices;
+			std::vector<unsigned int> indices;
+			std::vector<unsigned short> shortIndices;
+			std::vector<PackedTangent> tangents;
+			const void* vertexData;
+			const PackedTangent* tangentData; // nullptr without GenerateTangents
+			const void* indexData;
+			std::size_t vertexCount;
+			std::size_t indexCount;
+			std::size_t indexSize;
+			VertexFormat format;
+			std::vector<SubMesh> subMeshes;
+			std::vector<Lod> lods;
+			std::vector<Meshlet> meshlets;
+			Statistics statistics;
+			bool quantized;
+			glm::vec3 positionOffset;
+			glm::vec3 positionScale;
+			BoundingBox boundingBox;
+			BoundingSphere boundingSphere;
+			bool keepGeometry;
+		};
+
 	public:
 		Mesh();
 		~Mesh();
 
-		bool loadFromFile(const std::string& filename);
+		bool loadFromFile(const std::string& filename, unsigned int flags = None);
+
+		// loadFromFile in two halves : the first makes no GL call and can run on any thread, the second uploads on the GL thread
+		static bool loadDataFromFile(const std::string& filename, unsigned int flags, Data& data);
+		bool loadFromData(const Data& data);
+
+		// Any vertex type exposing a VertexLayout as TVertex::Layout
+		template <typename TVertex>
+		bool loadFromMemory(const TVertex* vertices, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount);
+		template <typename TVertex>
+		bool loadFromMemory(const TVertex* vertices, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount, const SubMesh* subMeshes, std::size_t subMeshCount);
 
 		void draw();
+		void drawSubMesh(std::size_t index);
+
+		// Draws the listed sub-meshes with a single call, batches use it to skip the culled ones
+		void drawSubMeshes(const std::size_t* subMeshes, std::size_t count);
+
+		void drawLod(std::size_t level);
+
+		// Draws instanceCount copies of a level, each reading its InstanceData from instanceBuffer at offset bytes
+		void drawLodInstanced(std::size_t level, unsigned int instanceBuffer, std::size_t offset, std::size_t instanceCount);
+
+		// Frustum and back-face culls the meshlets, then draws the visible ones, returns the number of draw ranges
+		// Meshlets only cover level 0, other levels and meshes loaded without meshlets are drawn whole
+		std::size_t drawVisible(const glm::mat4& modelView, const glm::mat4& projection, std::size_t level = 0);
+
+		// Coarsest level whose error projects under threshold, given as a fraction of the viewport height (about a pixel at 1080p)
+		std::size_t selectLod(const glm::mat4& modelView, const glm::mat4& projection, float threshold = 0.001f) const;
+
+		std::size_t getLodCount() const;
+		const Lod& getLod(std::size_t level) const;
+
+		std::size_t getMeshletCount() const;
+		const Meshlet& getMeshlet(std::size_t index) const;
+
+		std::size_t getSubMeshCount() const;
+		const SubMesh& getSubMesh(std::size_t index) const;
+
+		const Statistics& getStatistics() const;
+
+		// Model space bounds of every level of detail, left empty by loadFromMemory
+		const BoundingBox& getBoundingBox() const;
+		const BoundingSphere& getBoundingSphere() const;
+
+		bool hasTangents() const;
+
+		// Quantized positions are decoded as offset + scale * position, identity for unpacked meshes
+		bool isQuantized() const;
+		const glm::vec3& getPositionOffset() const;
+		const glm::vec3& getPositionScale() const;
 
 		bool isValid() const;
 
+		// Given once at construction and never reused, render queues sort draws by it
+		unsigned int getSortId() const;
+
+		// Level 0 as loaded with KeepGeometry, empty otherwise : quantized vertices decoded, indices with the sub-mesh base vertices applied
+		// Replaced on every load, so it always matches what is drawn
+		bool hasGeometry() const;
+		const std::vector<Vertex>& getGeometryVertices() const;
+		const std::vector<unsigned int>& getGeometryIndices() const;
+
 	private:
-		unsigned int mBuffers[2];
+		static bool loadDataFromCache(Data& data, unsigned int flags);
+		bool loadFromMemory(const void* vertices, std::size_t vertexCount, const VertexFormat& format, const unsigned int* indices, std::size_t indexCount, const SubMesh* subMeshes, std::size_t subMeshCount);
+		bool upload(const void* vertices, std::size_t vertexCount, const VertexFormat& format, const PackedTangent* tangents, const void* indices, std::size_t indexCount, std::size_t indexSize, const SubMesh* subMeshes, std::size_t subMeshCount);
+		void release();
+
+		// Points the vertex array and the draw offsets at the arena ranges, again whenever the arena moved them
+		void bindVertexArray();
+		void setupVertexArray();
+
+	private:
+		unsigned int mAllocations[GeometryArena::PoolCount];
+		unsigned int mGeneration;
+		unsigned int mSortId;
+		std::size_t mIndexOffset; // bytes into the arena index buffer
+		unsigned int mVertexArray;
 		unsigned int mVertices;
+		unsigned int mIndexType;
+		VertexFormat mFormat;
+		std::vector<SubMesh> mSubMeshes;
+		std::vector<int> mDrawCounts;
+		std::vector<const void*> mDrawOffsets;
+		std::vector<int> mDrawBaseVertices;
+		std::vector<Lod> mLods;
+		std::vector<Meshlet> mMeshlets;
+		std::vector<int> mVisibleCounts;
+		std::vector<const void*> mVisibleOffsets;
+		std::vector<int> mVisibleBaseVertices;
+		Statistics mStatistics;
+		bool mQuantized;
+		glm::vec3 mPositionOffset;
+		glm::vec3 mPositionScale;
+		BoundingBox mBoundingBox;
+		BoundingSphere mBoundingSphere;
+		std::vector<Vertex> mGeometryVertices;
+		std::vector<unsigned int> mGeometryIndices;
 };
 
+template <typename TVertex>
+bool Mesh::loadFromMemory(const TVertex* vertices, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount)
+{
+	SubMesh subMesh;
+	subMesh.indexOffset = 0;
+	subMesh.indexCount = (unsigned int)indexCount;
+	subMesh.baseVertex = 0;
+	subMesh.materialIndex = 0;
+	return loadFromMemory(vertices, vertexCount, indices, indexCount, &subMesh, 1);
+}
+
+template <typename TVertex>
+bool Mesh::loadFromMemory(const TVertex* vertices, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount, const SubMesh* subMeshes, std::size_t subMeshCount)
+{
+	return loadFromMemory(static_cast<const void*>(vertices), vertexCount, getVertexFormat<TVertex>(), indices, indexCount, subMeshes, subMeshCount);
+}
+
 } // namespace cmgl
\ No newline at end of file
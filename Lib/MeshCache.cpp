@@ -0,0 +1,184 @@
+#include "MeshCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const std::uint64_t section_alignment = 16;
+
+	std::uint64_t align_offset(std::uint64_t offset)
+	{
+		return (offset + section_alignment - 1) & ~(section_alignment - 1);
+	}
+}
+
+const std::uint32_t MeshCache::Magic = 0x4C474D43; // "CMGL"
+const std::uint32_t MeshCache::Version = 11;
+
+MeshCache::MeshCache()
+{
+	std::memset(&mHeader, 0, sizeof(mHeader));
+	mHeader.magic = Magic;
+	mHeader.version = Version;
+	for (std::size_t i = 0; i < SectionCount; i++)
+	{
+		mSections[i] = nullptr;
+	}
+}
+
+bool MeshCache::loadFromFile(const std::string& filename, std::uint64_t sourceHash)
+{
+	if (!mFile.open(filename))
+	{
+		return false;
+	}
+
+	const unsigned char* data = mFile.getData();
+	const std::size_t size = mFile.getSize();
+	if (data == nullptr || size < sizeof(Header))
+	{
+		mFile.close();
+		return false;
+	}
+
+	Header header;
+	std::memcpy(&header, data, sizeof(Header));
+	if (header.magic != Magic || header.version != Version || header.sourceHash != sourceHash)
+	{
+		mFile.close();
+		return false;
+	}
+
+	for (std::size_t i = 0; i < SectionCount; i++)
+	{
+		if (header.sectionOffsets[i] > size || header.sectionSizes[i] > size - header.sectionOffsets[i])
+		{
+			fprintf(stderr, "Mesh cache is truncated : %s\n", filename.c_str());
+			mFile.close();
+			return false;
+		}
+		mSections[i] = (header.sectionSizes[i] > 0) ? data + header.sectionOffsets[i] : nullptr;
+	}
+	mHeader = header;
+
+	return true;
+}
+
+bool MeshCache::saveToFile(const std::string& filename, std::uint64_t sourceHash) const
+{
+	Header header = mHeader;
+	header.magic = Magic;
+	header.version = Version;
+	header.sourceHash = sourceHash;
+
+	std::uint64_t offset = priv::align_offset(sizeof(Header));
+	for (std::size_t i = 0; i < SectionCount; i++)
+	{
+		header.sectionOffsets[i] = offset;
+		offset = priv::align_offset(offset + header.sectionSizes[i]);
+	}
+
+	std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		fprintf(stderr, "Failed to write mesh cache : %s\n", filename.c_str());
+		return false;
+	}
+
+	const char padding[priv::section_alignment] = {};
+	std::uint64_t position = sizeof(Header);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	for (std::size_t i = 0; i < SectionCount; i++)
+	{
+		file.write(padding, header.sectionOffsets[i] - position);
+		if (header.sectionSizes[i] > 0)
+		{
+			file.write(static_cast<const char*>(mSections[i]), header.sectionSizes[i]);
+		}
+		position = header.sectionOffsets[i] + header.sectionSizes[i];
+	}
+
+	if (!file)
+	{
+		fprintf(stderr, "Failed to write mesh cache : %s\n", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+void MeshCache::setFlags(std::uint32_t flags)
+{
+	mHeader.flags = flags;
+}
+
+void MeshCache::setCounts(std::uint32_t vertexCount, std::uint32_t vertexSize, std::uint32_t indexCount, std::uint32_t indexSize)
+{
+	mHeader.vertexCount = vertexCount;
+	mHeader.vertexSize = vertexSize;
+	mHeader.indexCount = indexCount;
+	mHeader.indexSize = indexSize;
+}
+
+void MeshCache::setSection(Section section, const void* data, std::size_t size)
+{
+	mSections[section] = data;
+	mHeader.sectionSizes[section] = (data != nullptr) ? size : 0;
+}
+
+const MeshCache::Header& MeshCache::getHeader() const
+{
+	return mHeader;
+}
+
+const void* MeshCache::getSection(Section section) const
+{
+	return mSections[section];
+}
+
+std::size_t MeshCache::getSectionSize(Section section) const
+{
+	return static_cast<std::size_t>(mHeader.sectionSizes[section]);
+}
+
+std::string MeshCache::getCacheFilename(const std::string& filename)
+{
+	return filename + ".cmglmesh";
+}
+
+std::uint64_t MeshCache::computeHash(const void* data, std::size_t size)
+{
+	// FNV-1a, fed 8 bytes at a time so hashing stays I/O-bound on large files
+	const std::uint64_t prime = 0x100000001B3ull;
+	std::uint64_t hash = 0xCBF29CE484222325ull ^ size;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	std::size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		hash = (hash ^ word) * prime;
+	}
+	for (; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * prime;
+	}
+	return hash;
+}
+
+bool MeshCache::computeFileHash(const std::string& filename, std::uint64_t& hash)
+{
+	MappedFile file;
+	if (!file.open(filename))
+	{
+		return false;
+	}
+	hash = computeHash(file.getData(), file.getSize());
+	return true;
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.hpp"
+
+namespace cmgl
+{
+
+// Binary mesh cache written next to the source file on first import
+// The file is memory-mapped on later loads and its sections are handed directly to the GPU
+class MeshCache
+{
+	public:
+		enum Section
+		{
+			Vertices,
+			Indices,
+			SubMeshes,
+			Statistics,
+			Quantization,
+			Meshlets,
+			Lods,
+			Bounds,
+			Tangents,
+			SectionCount
+		};
+
+		struct Header
+		{
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint64_t sourceHash;
+			std::uint32_t flags;
+			std::uint32_t vertexCount;
+			std::uint32_t vertexSize;
+			std::uint32_t indexCount;
+			std::uint32_t indexSize;
+			std::uint64_t sectionOffsets[SectionCount];
+			std::uint64_t sectionSizes[SectionCount];
+		};
+
+		static const std::uint32_t Magic;
+		static const std::uint32_t Version;
+
+	public:
+		MeshCache();
+
+		bool loadFromFile(const std::string& filename, std::uint64_t sourceHash);
+		bool saveToFile(const std::string& filename, std::uint64_t sourceHash) const;
+
+		void setFlags(std::uint32_t flags);
+		void setCounts(std::uint32_t vertexCount, std::uint32_t vertexSize, std::uint32_t indexCount, std::uint32_t indexSize);
+		void setSection(Section section, const void* data, std::size_t size);
+
+		const Header& getHeader() const;
+		const void* getSection(Section section) const;
+		std::size_t getSectionSize(Section section) const;
+
+		static std::string getCacheFilename(const std::string& filename);
+
+		static std::uint64_t computeHash(const void* data, std::size_t size);
+		static bool computeFileHash(const std::string& filename, std::uint64_t& hash);
+
+	private:
+		MappedFile mFile;
+		Header mHeader;
+		const void* mSections[SectionCount];
+};
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,677 @@
+#include "MeshCodec.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CMGL_CODEC_SSE2
+#endif
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const std::size_t lz_min_match = 4;
+	const std::size_t lz_max_offset = 65535;
+	const unsigned int lz_hash_bits = 14;
+
+	const std::size_t codec_fifo_size = 16;
+	const unsigned char codec_edge_miss = 0xF0;
+	const unsigned char codec_vertex_explicit = 0xFF;
+
+	std::uint32_t lz_hash(const unsigned char* data)
+	{
+		std::uint32_t word;
+		std::memcpy(&word, data, 4);
+		return (word * 2654435761u) >> (32 - lz_hash_bits);
+	}
+
+	void lz_write_length(std::vector<unsigned char>& destination, std::size_t length)
+	{
+		while (length >= 255)
+		{
+			destination.push_back(255);
+			length -= 255;
+		}
+		destination.push_back((unsigned char)length);
+	}
+
+	bool lz_read_length(const unsigned char*& source, const unsigned char* end, std::size_t& length)
+	{
+		unsigned char byte;
+		do
+		{
+			if (source == end)
+			{
+				return false;
+			}
+			byte = *source++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	void lz_write_sequence(std::vector<unsigned char>& destination, const unsigned char* literals, std::size_t literalCount, std::size_t offset, std::size_t matchLength)
+	{
+		const std::size_t matchCode = (matchLength >= lz_min_match) ? matchLength - lz_min_match : 0;
+		destination.push_back((unsigned char)(((literalCount < 15) ? literalCount : 15) << 4 | ((matchCode < 15) ? matchCode : 15)));
+		if (literalCount >= 15)
+		{
+			lz_write_length(destination, literalCount - 15);
+		}
+		destination.insert(destination.end(), literals, literals + literalCount);
+		if (matchLength >= lz_min_match)
+		{
+			destination.push_back((unsigned char)(offset & 0xFF));
+			destination.push_back((unsigned char)(offset >> 8));
+			if (matchCode >= 15)
+			{
+				lz_write_length(destination, matchCode - 15);
+			}
+		}
+	}
+
+	// Copies in steps of Step bytes and may write up to Step - 1 bytes past the end, callers keep that margin in both buffers
+	// Matches copied this way need an offset of at least Step, so that every step reads bytes written before it
+	template <std::size_t Step>
+	void lz_wild_copy(unsigned char* output, const unsigned char* source, std::size_t length)
+	{
+		unsigned char* const end = output + length;
+		do
+		{
+			std::memcpy(output, source, Step);
+			output += Step;
+			source += Step;
+		} while (output < end);
+	}
+
+	std::uint16_t zigzag16(std::uint16_t value)
+	{
+		return (std::uint16_t)((value << 1) ^ (std::uint16_t)((std::int16_t)value >> 15));
+	}
+
+	std::uint16_t unzigzag16(std::uint16_t value)
+	{
+		return (std::uint16_t)((value >> 1) ^ (std::uint16_t)(0 - (value & 1)));
+	}
+
+	// Vertex by vertex over a range of word columns, values holds the running sum of every word
+	void decode_vertex_words(unsigned char* bytes, std::size_t vertexSize, const unsigned char* planes, std::size_t vertexCount, std::size_t firstVertex, std::size_t firstWord, std::size_t lastWord, std::uint16_t* values)
+	{
+		for (std::size_t v = firstVertex; v < vertexCount; v++)
+		{
+			for (std::size_t w = firstWord; w < lastWord; w++)
+			{
+				const unsigned char* low = planes + 2 * w * vertexCount;
+				values[w] = (std::uint16_t)(values[w] + unzigzag16((std::uint16_t)(low[v] | (low[vertexCount + v] << 8))));
+				std::memcpy(bytes + v * vertexSize + 2 * w, &values[w], 2);
+			}
+		}
+	}
+
+#if defined(CMGL_CODEC_SSE2)
+	// Eight word columns of eight vertices at a time : each register is unzigzagged and prefix summed in place,
+	// then the 8x8 transpose turns the columns into vertices, stored 16 bytes at once
+	// Returns the number of vertices decoded, values receives the running sums for the remaining ones
+	std::size_t decode_vertex_words_sse2(unsigned char* bytes, std::size_t vertexSize, const unsigned char* planes, std::size_t vertexCount, std::size_t firstWord, std::uint16_t* values)
+	{
+		const unsigned char* low[8];
+		__m128i last[8];
+		for (std::size_t w = 0; w < 8; w++)
+		{
+			low[w] = planes + 2 * (firstWord + w) * vertexCount;
+			last[w] = _mm_setzero_si128();
+		}
+		const __m128i one = _mm_set1_epi16(1);
+
+		std::size_t v = 0;
+		for (; v + 8 <= vertexCount; v += 8)
+		{
+			__m128i words[8];
+			for (std::size_t w = 0; w < 8; w++)
+			{
+				const __m128i zigzag = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(low[w] + v)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(low[w] + vertexCount + v)));
+				__m128i delta = _mm_xor_si128(_mm_srli_epi16(zigzag, 1), _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(zigzag, one)));
+				delta = _mm_add_epi16(delta, _mm_slli_si128(delta, 2));
+				delta = _mm_add_epi16(delta, _mm_slli_si128(delta, 4));
+				delta = _mm_add_epi16(delta, _mm_slli_si128(delta, 8));
+				words[w] = _mm_add_epi16(delta, last[w]);
+				const __m128i top = _mm_shufflehi_epi16(words[w], 0xFF);
+				last[w] = _mm_unpackhi_epi64(top, top);
+			}
+
+			const __m128i pairs0 = _mm_unpacklo_epi16(words[0], words[1]);
+			const __m128i pairs1 = _mm_unpackhi_epi16(words[0], words[1]);
+			const __m128i pairs2 = _mm_unpacklo_epi16(words[2], words[3]);
+			const __m128i pairs3 = _mm_unpackhi_epi16(words[2], words[3]);
+			const __m128i pairs4 = _mm_unpacklo_epi16(words[4], words[5]);
+			const __m128i pairs5 = _mm_unpackhi_epi16(words[4], words[5]);
+			const __m128i pairs6 = _mm_unpacklo_epi16(words[6], words[7]);
+			const __m128i pairs7 = _mm_unpackhi_epi16(words[6], words[7]);
+			const __m128i quads0 = _mm_unpacklo_epi32(pairs0, pairs2);
+			const __m128i quads1 = _mm_unpackhi_epi32(pairs0, pairs2);
+			const __m128i quads2 = _mm_unpacklo_epi32(pairs1, pairs3);
+			const __m128i quads3 = _mm_unpackhi_epi32(pairs1, pairs3);
+			const __m128i quads4 = _mm_unpacklo_epi32(pairs4, pairs6);
+			const __m128i quads5 = _mm_unpackhi_epi32(pairs4, pairs6);
+			const __m128i quads6 = _mm_unpacklo_epi32(pairs5, pairs7);
+			const __m128i quads7 = _mm_unpackhi_epi32(pairs5, pairs7);
+			const __m128i vertices[8] =
+			{
+				_mm_unpacklo_epi64(quads0, quads4), _mm_unpackhi_epi64(quads0, quads4),
+				_mm_unpacklo_epi64(quads1, quads5), _mm_unpackhi_epi64(quads1, quads5),
+				_mm_unpacklo_epi64(quads2, quads6), _mm_unpackhi_epi64(quads2, quads6),
+				_mm_unpacklo_epi64(quads3, quads7), _mm_unpackhi_epi64(quads3, quads7)
+			};
+			unsigned char* output = bytes + v * vertexSize + 2 * firstWord;
+			for (std::size_t k = 0; k < 8; k++)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + k * vertexSize), vertices[k]);
+			}
+		}
+
+		for (std::size_t w = 0; w < 8; w++)
+		{
+			values[firstWord + w] = (std::uint16_t)_mm_cvtsi128_si32(last[w]);
+		}
+		return v;
+	}
+#endif
+
+	void write_varint(std::vector<unsigned char>& destination, std::uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			destination.push_back((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		destination.push_back((unsigned char)value);
+	}
+
+	bool read_varint(const unsigned char*& source, const unsigned char* end, std::uint32_t& value)
+	{
+		value = 0;
+		for (unsigned int shift = 0; shift < 35; shift += 7)
+		{
+			if (source == end)
+			{
+				return false;
+			}
+			const unsigned char byte = *source++;
+			value |= (std::uint32_t)(byte & 0x7F) << shift;
+			if (byte < 0x80)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Shared by both sides of the index codec, which must update it identically
+	struct IndexCodecState
+	{
+		unsigned int edges[codec_fifo_size][2];
+		unsigned int vertices[codec_fifo_size];
+		std::size_t edgeHead;
+		std::size_t vertexHead;
+		unsigned int next; // first vertex not referenced yet, vertex fetch order makes it the usual new vertex
+		unsigned int last; // last explicitly coded vertex, explicit vertices are deltas from it
+
+		IndexCodecState()
+			: edgeHead(0)
+			, vertexHead(0)
+			, next(0)
+			, last(0)
+		{
+			std::memset(edges, 0xFF, sizeof(edges));
+			std::memset(vertices, 0xFF, sizeof(vertices));
+		}
+
+		// FIFO indices count back from the most recent entry
+		int findEdge(unsigned int a, unsigned int b) const
+		{
+			for (std::size_t i = 0; i < codec_fifo_size; i++)
+			{
+				const std::size_t slot = (edgeHead + codec_fifo_size - 1 - i) % codec_fifo_size;
+				if (edges[slot][0] == a && edges[slot][1] == b)
+				{
+					return (int)i;
+				}
+			}
+			return -1;
+		}
+
+		int findVertex(unsigned int v) const
+		{
+			for (std::size_t i = 0; i < codec_fifo_size; i++)
+			{
+				if (vertices[(vertexHead + codec_fifo_size - 1 - i) % codec_fifo_size] == v)
+				{
+					return (int)i;
+				}
+			}
+			return -1;
+		}
+
+		const unsigned int* getEdge(std::size_t index) const
+		{
+			return edges[(edgeHead + codec_fifo_size - 1 - index) % codec_fifo_size];
+		}
+
+		unsigned int getVertex(std::size_t index) const
+		{
+			return vertices[(vertexHead + codec_fifo_size - 1 - index) % codec_fifo_size];
+		}
+
+		// Stored reversed : the neighbour across an edge walks it in the opposite direction
+		void pushEdge(unsigned int a, unsigned int b)
+		{
+			edges[edgeHead][0] = b;
+			edges[edgeHead][1] = a;
+			edgeHead = (edgeHead + 1) % codec_fifo_size;
+		}
+
+		void pushVertex(unsigned int v)
+		{
+			vertices[vertexHead] = v;
+			vertexHead = (vertexHead + 1) % codec_fifo_size;
+		}
+	};
+
+	// Vertex code : 0 for the next new vertex, 1 + i for the FIFO entry i, codec_vertex_explicit for a zigzag varint delta written to data
+	unsigned char encode_vertex(IndexCodecState& state, unsigned int v, std::vector<unsigned char>& data)
+	{
+		if (v == state.next)
+		{
+			state.next++;
+			state.pushVertex(v);
+			return 0;
+		}
+		const int fifo = state.findVertex(v);
+		if (fifo >= 0)
+		{
+			return (unsigned char)(1 + fifo);
+		}
+		const std::int32_t delta = (std::int32_t)(v - state.last);
+		write_varint(data, ((std::uint32_t)delta << 1) ^ (std::uint32_t)(delta >> 31));
+		state.last = v;
+		state.pushVertex(v);
+		return codec_vertex_explicit;
+	}
+
+	bool decode_vertex(IndexCodecState& state, unsigned char code, const unsigned char*& data, const unsigned char* dataEnd, unsigned int& v)
+	{
+		if (code == 0)
+		{
+			v = state.next++;
+			state.pushVertex(v);
+		}
+		else if (code <= codec_fifo_size)
+		{
+			v = state.getVertex(code - 1);
+		}
+		else if (code == codec_vertex_explicit)
+		{
+			std::uint32_t zigzag;
+			if (!read_varint(data, dataEnd, zigzag))
+			{
+				return false;
+			}
+			v = state.last + ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+			state.last = v;
+			state.pushVertex(v);
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	unsigned int read_index(const void* indices, std::size_t indexSize, std::size_t i)
+	{
+		return (indexSize == 2) ? static_cast<const std::uint16_t*>(indices)[i] : static_cast<const std::uint32_t*>(indices)[i];
+	}
+
+	// Instantiated per index type so that the triangle loop stores without a size test
+	template <typename T>
+	bool decode_triangles(T* indices, std::size_t indexCount, const unsigned char* codes, const unsigned char* codesEnd, const unsigned char* data, const unsigned char* dataEnd)
+	{
+		IndexCodecState state;
+		for (std::size_t i = 0; i < indexCount; i += 3)
+		{
+			if (codes == codesEnd)
+			{
+				return false;
+			}
+			const unsigned char code = *codes++;
+			unsigned int a, b, c;
+			if ((code >> 4) != 15)
+			{
+				const unsigned int* edge = state.getEdge(code >> 4);
+				a = edge[0];
+				b = edge[1];
+				unsigned char vertexCode = code & 15;
+				if (vertexCode == 15)
+				{
+					if (codes == codesEnd)
+					{
+						return false;
+					}
+					vertexCode = *codes++;
+				}
+				// The next new vertex is by far the most common code in vertex fetch order, kept out of the call
+				if (vertexCode == 0)
+				{
+					c = state.next++;
+					state.pushVertex(c);
+				}
+				else if (!decode_vertex(state, vertexCode, data, dataEnd, c))
+				{
+					return false;
+				}
+				state.pushEdge(b, c);
+				state.pushEdge(c, a);
+			}
+			else
+			{
+				if (codesEnd - codes < 3 || !decode_vertex(state, codes[0], data, dataEnd, a) || !decode_vertex(state, codes[1], data, dataEnd, b) || !decode_vertex(state, codes[2], data, dataEnd, c))
+				{
+					return false;
+				}
+				codes += 3;
+				state.pushEdge(a, b);
+				state.pushEdge(b, c);
+				state.pushEdge(c, a);
+			}
+			indices[i] = (T)a;
+			indices[i + 1] = (T)b;
+			indices[i + 2] = (T)c;
+		}
+		return codes == codesEnd && data == dataEnd;
+	}
+}
+
+bool encodeVertexBuffer(std::vector<unsigned char>& destination, const void* vertices, std::size_t vertexCount, std::size_t vertexSize)
+{
+	if (vertexSize % 2 != 0)
+	{
+		return false;
+	}
+	const std::size_t wordCount = vertexSize / 2;
+	const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+	std::vector<unsigned char> planes(vertexCount * wordCount * 2);
+	for (std::size_t w = 0; w < wordCount; w++)
+	{
+		unsigned char* low = planes.data() + 2 * w * vertexCount;
+		unsigned char* high = low + vertexCount;
+		std::uint16_t previous = 0;
+		for (std::size_t v = 0; v < vertexCount; v++)
+		{
+			std::uint16_t value;
+			std::memcpy(&value, bytes + v * vertexSize + 2 * w, 2);
+			const std::uint16_t zigzag = priv::zigzag16((std::uint16_t)(value - previous));
+			previous = value;
+			low[v] = (unsigned char)(zigzag & 0xFF);
+			high[v] = (unsigned char)(zigzag >> 8);
+		}
+	}
+
+	destination.clear();
+	compressLz(destination, planes.data(), planes.size());
+	return true;
+}
+
+bool decodeVertexBuffer(void* destination, std::size_t vertexCount, std::size_t vertexSize, const unsigned char* source, std::size_t sourceSize)
+{
+	if (vertexSize % 2 != 0)
+	{
+		return false;
+	}
+	const std::size_t wordCount = vertexSize / 2;
+	std::unique_ptr<unsigned char[]> planes(new unsigned char[vertexCount * vertexSize]);
+	if (!decompressLz(planes.get(), vertexCount * vertexSize, source, sourceSize))
+	{
+		return false;
+	}
+
+	// Groups of eight words go through SSE2, the other words and the last vertices of each group one by one
+	unsigned char* bytes = static_cast<unsigned char*>(destination);
+	std::vector<std::uint16_t> values(wordCount, 0);
+	std::size_t simdWords = 0;
+#if defined(CMGL_CODEC_SSE2)
+	simdWords = wordCount - wordCount % 8;
+	for (std::size_t w = 0; w < simdWords; w += 8)
+	{
+		const std::size_t decoded = priv::decode_vertex_words_sse2(bytes, vertexSize, planes.get(), vertexCount, w, values.data());
+		priv::decode_vertex_words(bytes, vertexSize, planes.get(), vertexCount, decoded, w, w + 8, values.data());
+	}
+#endif
+	priv::decode_vertex_words(bytes, vertexSize, planes.get(), vertexCount, 0, simdWords, wordCount, values.data());
+	return true;
+}
+
+bool encodeIndexBuffer(std::vector<unsigned char>& destination, const void* indices, std::size_t indexCount, std::size_t indexSize)
+{
+	if (indexCount % 3 != 0 || (indexSize != 2 && indexSize != 4))
+	{
+		return false;
+	}
+	priv::IndexCodecState state;
+	std::vector<unsigned char> codes;
+	std::vector<unsigned char> data;
+	codes.reserve(indexCount / 3);
+	for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		unsigned int triangle[3] = { priv::read_index(indices, indexSize, i), priv::read_index(indices, indexSize, i + 1), priv::read_index(indices, indexSize, i + 2) };
+
+		// Rotate the triangle so that its shared edge, if any, comes first, a high nibble of 15 marks the triangles without one
+		int edge = -1;
+		for (unsigned int r = 0; r < 3; r++)
+		{
+			const int found = state.findEdge(triangle[0], triangle[1]);
+			if (found >= 0 && found < 15)
+			{
+				edge = found;
+				break;
+			}
+			const unsigned int first = triangle[0];
+			triangle[0] = triangle[1];
+			triangle[1] = triangle[2];
+			triangle[2] = first;
+		}
+		const unsigned int a = triangle[0];
+		const unsigned int b = triangle[1];
+		const unsigned int c = triangle[2];
+
+		if (edge >= 0)
+		{
+			// The third vertex code shares the byte when it fits in the low nibble
+			const unsigned char vertexCode = priv::encode_vertex(state, c, data);
+			if (vertexCode < 15)
+			{
+				codes.push_back((unsigned char)(edge << 4 | vertexCode));
+			}
+			else
+			{
+				codes.push_back((unsigned char)(edge << 4 | 15));
+				codes.push_back(vertexCode);
+			}
+			state.pushEdge(b, c);
+			state.pushEdge(c, a);
+		}
+		else
+		{
+			codes.push_back(priv::codec_edge_miss);
+			codes.push_back(priv::encode_vertex(state, a, data));
+			codes.push_back(priv::encode_vertex(state, b, data));
+			codes.push_back(priv::encode_vertex(state, c, data));
+			state.pushEdge(a, b);
+			state.pushEdge(b, c);
+			state.pushEdge(c, a);
+		}
+	}
+
+	// Code count, codes then explicit deltas, all through the LZ stage
+	std::vector<unsigned char> stream;
+	stream.reserve(4 + codes.size() + data.size());
+	priv::write_varint(stream, (std::uint32_t)codes.size());
+	priv::write_varint(stream, (std::uint32_t)data.size());
+	stream.insert(stream.end(), codes.begin(), codes.end());
+	stream.insert(stream.end(), data.begin(), data.end());
+
+	destination.clear();
+	priv::write_varint(destination, (std::uint32_t)stream.size());
+	compressLz(destination, stream.data(), stream.size());
+	return true;
+}
+
+bool decodeIndexBuffer(void* destination, std::size_t indexCount, std::size_t indexSize, const unsigned char* source, std::size_t sourceSize)
+{
+	if (indexCount % 3 != 0 || (indexSize != 2 && indexSize != 4))
+	{
+		return false;
+	}
+	const unsigned char* sourceEnd = source + sourceSize;
+	std::uint32_t streamSize = 0;
+	if (!priv::read_varint(source, sourceEnd, streamSize))
+	{
+		return false;
+	}
+	std::unique_ptr<unsigned char[]> stream(new unsigned char[streamSize]);
+	if (!decompressLz(stream.get(), streamSize, source, sourceEnd - source))
+	{
+		return false;
+	}
+
+	const unsigned char* header = stream.get();
+	const unsigned char* streamEnd = stream.get() + streamSize;
+	std::uint32_t codeSize = 0;
+	std::uint32_t dataSize = 0;
+	if (!priv::read_varint(header, streamEnd, codeSize) || !priv::read_varint(header, streamEnd, dataSize) || (std::size_t)(streamEnd - header) != (std::size_t)codeSize + dataSize)
+	{
+		return false;
+	}
+	const unsigned char* codes = header;
+	const unsigned char* codesEnd = codes + codeSize;
+	const unsigned char* data = codesEnd;
+	const unsigned char* dataEnd = streamEnd;
+
+	if (indexSize == 2)
+	{
+		return priv::decode_triangles(static_cast<std::uint16_t*>(destination), indexCount, codes, codesEnd, data, dataEnd);
+	}
+	return priv::decode_triangles(static_cast<std::uint32_t*>(destination), indexCount, codes, codesEnd, data, dataEnd);
+}
+
+void compressLz(std::vector<unsigned char>& destination, const unsigned char* source, std::size_t size)
+{
+	// Greedy parse with a single candidate per hash bucket, positions are stored plus one so that zero means empty
+	std::vector<std::uint32_t> table((std::size_t)1 << priv::lz_hash_bits, 0);
+	std::size_t anchor = 0;
+	std::size_t i = 0;
+	while (i + priv::lz_min_match <= size)
+	{
+		const std::uint32_t hash = priv::lz_hash(source + i);
+		const std::size_t candidate = table[hash];
+		table[hash] = (std::uint32_t)(i + 1);
+		if (candidate == 0 || i + 1 - candidate > priv::lz_max_offset || std::memcmp(source + candidate - 1, source + i, priv::lz_min_match) != 0)
+		{
+			i++;
+			continue;
+		}
+
+		const std::size_t match = candidate - 1;
+		std::size_t length = priv::lz_min_match;
+		while (i + length < size && source[match + length] == source[i + length])
+		{
+			length++;
+		}
+		priv::lz_write_sequence(destination, source + anchor, i - anchor, i - match, length);
+		i += length;
+		anchor = i;
+	}
+	priv::lz_write_sequence(destination, source + anchor, size - anchor, 0, 0);
+}
+
+bool decompressLz(unsigned char* destination, std::size_t size, const unsigned char* source, std::size_t sourceSize)
+{
+	unsigned char* output = destination;
+	unsigned char* const outputEnd = destination + size;
+	const unsigned char* const sourceEnd = source + sourceSize;
+	while (source < sourceEnd)
+	{
+		const unsigned char token = *source++;
+		std::size_t literalCount = token >> 4;
+		if (literalCount == 15 && !priv::lz_read_length(source, sourceEnd, literalCount))
+		{
+			return false;
+		}
+		if (literalCount > (std::size_t)(sourceEnd - source) || literalCount > (std::size_t)(outputEnd - output))
+		{
+			return false;
+		}
+		if (literalCount + 16 <= (std::size_t)(sourceEnd - source) && literalCount + 16 <= (std::size_t)(outputEnd - output))
+		{
+			priv::lz_wild_copy<16>(output, source, literalCount);
+		}
+		else
+		{
+			std::memcpy(output, source, literalCount);
+		}
+		output += literalCount;
+		source += literalCount;
+
+		// The last sequence only has literals
+		if (source == sourceEnd)
+		{
+			break;
+		}
+		if (sourceEnd - source < 2)
+		{
+			return false;
+		}
+		const std::size_t offset = (std::size_t)source[0] | ((std::size_t)source[1] << 8);
+		source += 2;
+		std::size_t length = token & 15;
+		if (length == 15 && !priv::lz_read_length(source, sourceEnd, length))
+		{
+			return false;
+		}
+		length += priv::lz_min_match;
+		if (offset == 0 || offset > (std::size_t)(output - destination) || length > (std::size_t)(outputEnd - output))
+		{
+			return false;
+		}
+
+		// Overlapping matches repeat a short pattern and must be copied forward, in steps no longer than the offset
+		const unsigned char* match = output - offset;
+		const bool margin = length + 16 <= (std::size_t)(outputEnd - output);
+		if (margin && offset >= 16)
+		{
+			priv::lz_wild_copy<16>(output, match, length);
+		}
+		else if (margin && offset >= 8)
+		{
+			priv::lz_wild_copy<8>(output, match, length);
+		}
+		else if (offset >= length)
+		{
+			std::memcpy(output, match, length);
+		}
+		else
+		{
+			for (std::size_t k = 0; k < length; k++)
+			{
+				output[k] = match[k];
+			}
+		}
+		output += length;
+	}
+	return output == outputEnd;
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace cmgl
+{
+
+// Lossless codecs for the vertex and index sections of the mesh cache, each stage ends in a small LZ77 byte compressor
+// Encoders return false on sizes the format cannot represent, decoders also check every read and write against the buffer sizes and return false on corrupted input
+
+// Every 16-bit word of a vertex becomes its zigzagged difference with the previous vertex, split into low and high byte planes
+// Best on quantized vertices ordered by optimizeVertexFetch, where neighbours differ by small amounts, vertexSize must be even
+bool encodeVertexBuffer(std::vector<unsigned char>& destination, const void* vertices, std::size_t vertexCount, std::size_t vertexSize);
+bool decodeVertexBuffer(void* destination, std::size_t vertexCount, std::size_t vertexSize, const unsigned char* source, std::size_t sourceSize);
+
+// Triangles sharing an edge with one of the 16 last edges cost a byte, as do vertices that are the next unseen one or still in a 16 entries FIFO
+// Triangles may come back rotated (same winding and order), indexSize is 2 or 4
+bool encodeIndexBuffer(std::vector<unsigned char>& destination, const void* indices, std::size_t indexCount, std::size_t indexSize);
+bool decodeIndexBuffer(void* destination, std::size_t indexCount, std::size_t indexSize, const unsigned char* source, std::size_t sourceSize);
+
+// LZ4-like byte format : literal runs and 64 KiB window matches, decoded with plain copies
+void compressLz(std::vector<unsigned char>& destination, const unsigned char* source, std::size_t size);
+bool decompressLz(unsigned char* destination, std::size_t size, const unsigned char* source, std::size_t sourceSize);
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,1418 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const int vcache_size = 32;
+	const int vcache_max_valence = 32;
+	const float vcache_decay_power = 1.5f;
+	const float vcache_last_triangle_score = 0.75f;
+	const float vcache_valence_boost_scale = 2.0f;
+	const float vcache_valence_boost_power = 0.5f;
+
+	struct VertexCacheScores
+	{
+		VertexCacheScores()
+		{
+			for (int i = 0; i < vcache_size; i++)
+			{
+				if (i < 3)
+				{
+					// The last triangle's vertices get a fixed score so we don't just reuse them over and over
+					position[i] = vcache_last_triangle_score;
+				}
+				else
+				{
+					const float scaler = 1.0f / (vcache_size - 3);
+					position[i] = std::pow(1.0f - (i - 3) * scaler, vcache_decay_power);
+				}
+			}
+			valence[0] = 0.0f;
+			for (int i = 1; i <= vcache_max_valence; i++)
+			{
+				valence[i] = vcache_valence_boost_scale * std::pow((float)i, -vcache_valence_boost_power);
+			}
+		}
+
+		float get(int cachePosition, unsigned int remainingValence) const
+		{
+			if (remainingValence == 0)
+			{
+				return -1.0f;
+			}
+			float score = (cachePosition >= 0) ? position[cachePosition] : 0.0f;
+			if (remainingValence <= (unsigned int)vcache_max_valence)
+			{
+				score += valence[remainingValence];
+			}
+			else
+			{
+				score += vcache_valence_boost_scale * std::pow((float)remainingValence, -vcache_valence_boost_power);
+			}
+			return score;
+		}
+
+		float position[vcache_size];
+		float valence[vcache_max_valence + 1];
+	};
+
+	const std::size_t vertex_components = sizeof(Vertex) / sizeof(float);
+
+	struct VertexKey
+	{
+		std::int32_t values[vertex_components];
+	};
+
+	VertexKey make_vertex_key(const Vertex& vertex)
+	{
+		float components[vertex_components];
+		std::memcpy(components, &vertex, sizeof(Vertex));
+		VertexKey key;
+		for (std::size_t i = 0; i < vertex_components; i++)
+		{
+			const float value = components[i] + 0.0f; // -0.0f and 0.0f weld together
+			std::memcpy(&key.values[i], &value, sizeof(float));
+		}
+		return key;
+	}
+
+	std::uint32_t hash_vertex_key(const VertexKey& key)
+	{
+		std::uint32_t hash = 0;
+		for (std::size_t i = 0; i < vertex_components; i++)
+		{
+			// MurmurHash2 mixing step
+			std::uint32_t k = (std::uint32_t)key.values[i] * 0x5BD1E995u;
+			k ^= k >> 24;
+			k *= 0x5BD1E995u;
+			hash = (hash * 0x5BD1E995u) ^ k;
+		}
+		return hash;
+	}
+
+	// Cell of a kept vertex position, heading the list of the kept vertices inside it
+	struct WeldCell
+	{
+		std::int64_t coordinates[3];
+		unsigned int first;
+	};
+
+	// Huge and non-finite coordinates are clamped, so that the neighbouring cells never overflow
+	std::int64_t weld_cell_coordinate(double scaled)
+	{
+		const double limit = 4611686018427387904.0; // 2^62
+		if (scaled != scaled)
+		{
+			return 0;
+		}
+		return (std::int64_t)std::max(-limit, std::min(std::floor(scaled), limit));
+	}
+
+	std::uint32_t hash_weld_cell(const std::int64_t* coordinates)
+	{
+		std::uint32_t hash = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			const std::uint64_t value = (std::uint64_t)coordinates[i];
+			const std::uint32_t halves[2] = { (std::uint32_t)value, (std::uint32_t)(value >> 32) };
+			for (int h = 0; h < 2; h++)
+			{
+				// MurmurHash2 mixing step
+				std::uint32_t k = halves[h] * 0x5BD1E995u;
+				k ^= k >> 24;
+				k *= 0x5BD1E995u;
+				hash = (hash * 0x5BD1E995u) ^ k;
+			}
+		}
+		return hash;
+	}
+
+	// Slot of the cell in the open addressing table, or the empty slot where it goes
+	std::size_t find_weld_cell(const std::vector<unsigned int>& table, const std::vector<WeldCell>& cells, const std::int64_t* coordinates)
+	{
+		const std::size_t mask = table.size() - 1;
+		std::size_t slot = hash_weld_cell(coordinates) & mask;
+		while (table[slot] != ~0u && std::memcmp(cells[table[slot]].coordinates, coordinates, sizeof(cells[0].coordinates)) != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+	bool vertices_near(const Vertex& a, const Vertex& b, float epsilon)
+	{
+		float componentsA[vertex_components];
+		float componentsB[vertex_components];
+		std::memcpy(componentsA, &a, sizeof(Vertex));
+		std::memcpy(componentsB, &b, sizeof(Vertex));
+		for (std::size_t i = 0; i < vertex_components; i++)
+		{
+			if (!(std::fabs(componentsA[i] - componentsB[i]) <= epsilon))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Every vertex joins the first kept vertex whose components all lie within epsilon of its own
+	// Positions are bucketed in cells of size 2 * epsilon : a position within epsilon is either in the same cell
+	// or in the adjacent one on the side of the nearest cell edge, so 8 cells cover every candidate
+	std::size_t weld_near_vertices(Vertex* vertices, std::size_t vertexCount, std::vector<unsigned int>& remap, std::size_t capacity, float epsilon)
+	{
+		const unsigned int empty = ~0u;
+		const double cellSize = 2.0 * (double)epsilon;
+		std::vector<unsigned int> table(capacity, empty);
+		std::vector<WeldCell> cells;
+		cells.reserve(vertexCount);
+		std::vector<unsigned int> next; // next kept vertex of the same cell
+		next.reserve(vertexCount);
+
+		std::size_t uniqueCount = 0;
+		for (std::size_t i = 0; i < vertexCount; i++)
+		{
+			std::int64_t cell[3];
+			std::int64_t side[3];
+			for (int a = 0; a < 3; a++)
+			{
+				const double scaled = (double)vertices[i].position[a] / cellSize;
+				cell[a] = weld_cell_coordinate(scaled);
+				side[a] = (scaled - std::floor(scaled) < 0.5) ? -1 : 1;
+			}
+
+			unsigned int match = empty;
+			for (int n = 0; n < 8 && match == empty; n++)
+			{
+				const std::int64_t neighbour[3] = { cell[0] + ((n & 1) ? side[0] : 0), cell[1] + ((n & 2) ? side[1] : 0), cell[2] + ((n & 4) ? side[2] : 0) };
+				const unsigned int found = table[find_weld_cell(table, cells, neighbour)];
+				for (unsigned int v = (found != empty) ? cells[found].first : empty; v != empty && match == empty; v = next[v])
+				{
+					if (vertices_near(vertices[v], vertices[i], epsilon))
+					{
+						match = v;
+					}
+				}
+			}
+
+			if (match == empty)
+			{
+				const std::size_t slot = find_weld_cell(table, cells, cell);
+				if (table[slot] == empty)
+				{
+					WeldCell added;
+					std::memcpy(added.coordinates, cell, sizeof(cell));
+					added.first = empty;
+					table[slot] = (unsigned int)cells.size();
+					cells.push_back(added);
+				}
+				WeldCell& own = cells[table[slot]];
+				next.push_back(own.first);
+				own.first = (unsigned int)uniqueCount;
+				vertices[uniqueCount] = vertices[i];
+				match = (unsigned int)uniqueCount;
+				uniqueCount++;
+			}
+			remap[i] = match;
+		}
+		return uniqueCount;
+	}
+
+	const int overdraw_grid_size = 256;
+	const unsigned int overdraw_cache_size = 16;
+
+	struct OverdrawBuffer
+	{
+		float depth[overdraw_grid_size][overdraw_grid_size][2];
+		unsigned int shaded[overdraw_grid_size][overdraw_grid_size][2];
+	};
+
+	unsigned int simulate_cache_misses(const unsigned int* triangle, std::vector<unsigned int>& timestamps, unsigned int& time)
+	{
+		unsigned int misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			if (time - timestamps[triangle[k]] > overdraw_cache_size)
+			{
+				timestamps[triangle[k]] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	float edge_function(float ax, float ay, float bx, float by, float cx, float cy)
+	{
+		return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	}
+
+	// Rasterizes one triangle into the layer of the view it faces, the other view culls it as a back face
+	// Layer 0 looks down +z (smaller depth wins), layer 1 looks down -z (larger depth wins)
+	void rasterize_overdraw(OverdrawBuffer& buffer, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+	{
+		const float area = edge_function(v0.x, v0.y, v1.x, v1.y, v2.x, v2.y);
+		if (area == 0.0f)
+		{
+			return;
+		}
+		const float invArea = 1.0f / area;
+		const int layer = (area > 0.0f) ? 1 : 0;
+		const float direction = (area > 0.0f) ? -1.0f : 1.0f;
+
+		const int minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+		const int minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+		const int maxX = std::min(overdraw_grid_size - 1, (int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+		const int maxY = std::min(overdraw_grid_size - 1, (int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+		for (int y = minY; y <= maxY; y++)
+		{
+			for (int x = minX; x <= maxX; x++)
+			{
+				const float px = (float)x + 0.5f;
+				const float py = (float)y + 0.5f;
+				const float w0 = edge_function(v1.x, v1.y, v2.x, v2.y, px, py) * invArea;
+				const float w1 = edge_function(v2.x, v2.y, v0.x, v0.y, px, py) * invArea;
+				const float w2 = edge_function(v0.x, v0.y, v1.x, v1.y, px, py) * invArea;
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+				{
+					continue;
+				}
+				const float depth = direction * (w0 * v0.z + w1 * v1.z + w2 * v2.z);
+				if (depth < buffer.depth[y][x][layer])
+				{
+					buffer.depth[y][x][layer] = depth;
+					buffer.shaded[y][x][layer]++;
+				}
+			}
+		}
+	}
+
+	// Bounding sphere around the box center, and the cone containing every triangle normal (meshoptimizer's meshopt_computeClusterBounds)
+	Meshlet make_meshlet(const unsigned int* indices, std::size_t indexOffset, std::size_t indexCount, const Vertex* vertices)
+	{
+		Meshlet meshlet;
+		meshlet.indexOffset = (unsigned int)indexOffset;
+		meshlet.indexCount = (unsigned int)indexCount;
+		meshlet.baseVertex = 0;
+		meshlet.subMesh = 0;
+
+		const unsigned int* begin = indices + indexOffset;
+		glm::vec3 minimum = vertices[begin[0]].position;
+		glm::vec3 maximum = minimum;
+		for (std::size_t i = 1; i < indexCount; i++)
+		{
+			minimum = glm::min(minimum, vertices[begin[i]].position);
+			maximum = glm::max(maximum, vertices[begin[i]].position);
+		}
+		meshlet.center = (minimum + maximum) * 0.5f;
+		meshlet.radius = 0.0f;
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			meshlet.radius = std::max(meshlet.radius, glm::length(vertices[begin[i]].position - meshlet.center));
+		}
+
+		std::vector<glm::vec3> normals;
+		normals.reserve(indexCount / 3);
+		glm::vec3 axis(0.0f);
+		for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const glm::vec3& p0 = vertices[begin[i]].position;
+			const glm::vec3 normal = glm::cross(vertices[begin[i + 1]].position - p0, vertices[begin[i + 2]].position - p0);
+			const float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		meshlet.coneCutoff = 1.0f;
+		const float axisLength = glm::length(axis);
+		if (axisLength > 0.0f)
+		{
+			meshlet.coneAxis = axis / axisLength;
+			float minimumDot = 1.0f;
+			for (std::size_t i = 0; i < normals.size(); i++)
+			{
+				minimumDot = std::min(minimumDot, glm::dot(meshlet.coneAxis, normals[i]));
+			}
+			// Cones wider than ~84 degrees almost never get culled, keep them always visible
+			if (minimumDot > 0.1f)
+			{
+				meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+			}
+		}
+		return meshlet;
+	}
+
+	// Symmetric 4x4 quadric of squared distances to a set of planes, weighted by area (Garland & Heckbert)
+	struct Quadric
+	{
+		float a00, a11, a22, a10, a20, a21;
+		float b0, b1, b2;
+		float c;
+		float w;
+	};
+
+	Quadric make_plane_quadric(const glm::vec3& normal, float distance, float weight)
+	{
+		Quadric q;
+		q.a00 = normal.x * normal.x * weight;
+		q.a11 = normal.y * normal.y * weight;
+		q.a22 = normal.z * normal.z * weight;
+		q.a10 = normal.y * normal.x * weight;
+		q.a20 = normal.z * normal.x * weight;
+		q.a21 = normal.z * normal.y * weight;
+		q.b0 = normal.x * distance * weight;
+		q.b1 = normal.y * distance * weight;
+		q.b2 = normal.z * distance * weight;
+		q.c = distance * distance * weight;
+		q.w = weight;
+		return q;
+	}
+
+	void add_quadric(Quadric& q, const Quadric& r)
+	{
+		q.a00 += r.a00;
+		q.a11 += r.a11;
+		q.a22 += r.a22;
+		q.a10 += r.a10;
+		q.a20 += r.a20;
+		q.a21 += r.a21;
+		q.b0 += r.b0;
+		q.b1 += r.b1;
+		q.b2 += r.b2;
+		q.c += r.c;
+		q.w += r.w;
+	}
+
+	// Mean squared distance from p to the planes accumulated in q
+	float quadric_error(const Quadric& q, const glm::vec3& p)
+	{
+		const float rx = q.a00 * p.x + q.a10 * p.y + q.a20 * p.z + 2.0f * q.b0;
+		const float ry = q.a10 * p.x + q.a11 * p.y + q.a21 * p.z + 2.0f * q.b1;
+		const float rz = q.a20 * p.x + q.a21 * p.y + q.a22 * p.z + 2.0f * q.b2;
+		const float error = rx * p.x + ry * p.y + rz * p.z + q.c;
+		return (q.w > 0.0f) ? std::fabs(error) / q.w : 0.0f;
+	}
+
+	// How a vertex may move during simplification
+	enum SimplifyKind
+	{
+		Manifold, // anywhere along its edges
+		Border, // only along the open border of the mesh
+		Seam, // only along the UV / normal seam, together with its twin vertex
+		Locked // never
+	};
+
+	const float simplify_border_weight = 10.0f;
+
+	// Directed edges grouped by source vertex, rebuilt from the current triangles
+	struct EdgeAdjacency
+	{
+		void build(const unsigned int* indices, std::size_t indexCount, const unsigned int* remap, std::size_t vertexCount)
+		{
+			offsets.assign(vertexCount + 1, 0);
+			for (std::size_t i = 0; i < indexCount; i++)
+			{
+				offsets[remap[indices[i]] + 1]++;
+			}
+			for (std::size_t v = 0; v < vertexCount; v++)
+			{
+				offsets[v + 1] += offsets[v];
+			}
+			targets.resize(indexCount);
+			std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+			for (std::size_t i = 0; i < indexCount; i += 3)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					const unsigned int a = remap[indices[i + k]];
+					const unsigned int b = remap[indices[i + (k + 1) % 3]];
+					targets[fill[a]++] = b;
+				}
+			}
+		}
+
+		bool has(unsigned int a, unsigned int b) const
+		{
+			return std::find(targets.begin() + offsets[a], targets.begin() + offsets[a + 1], b) != targets.begin() + offsets[a + 1];
+		}
+
+		// Counts, for every vertex, the leaving and arriving edges that have no opposite edge
+		void countOpenEdges(std::vector<unsigned int>& openOut, std::vector<unsigned int>& openIn) const
+		{
+			openOut.assign(offsets.size() - 1, 0);
+			openIn.assign(offsets.size() - 1, 0);
+			for (unsigned int a = 0; a + 1 < offsets.size(); a++)
+			{
+				for (unsigned int i = offsets[a]; i < offsets[a + 1]; i++)
+				{
+					if (!has(targets[i], a))
+					{
+						openOut[a]++;
+						openIn[targets[i]]++;
+					}
+				}
+			}
+		}
+
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> targets;
+	};
+
+	struct Collapse
+	{
+		unsigned int from;
+		unsigned int to;
+		float error;
+	};
+
+	bool has_triangle_flip(const unsigned int* indices, const std::vector<unsigned int>& triangles, const std::vector<unsigned int>& offsets, const std::vector<glm::vec3>& positions, const unsigned int* remap, unsigned int from, unsigned int to)
+	{
+		const unsigned int position = remap[from];
+		for (unsigned int i = offsets[position]; i < offsets[position + 1]; i++)
+		{
+			const unsigned int* triangle = indices + 3 * triangles[i];
+			glm::vec3 before[3];
+			glm::vec3 after[3];
+			bool collapsed = false;
+			for (int k = 0; k < 3; k++)
+			{
+				collapsed |= (remap[triangle[k]] == remap[to]);
+				before[k] = positions[triangle[k]];
+				after[k] = (remap[triangle[k]] == position) ? positions[to] : before[k];
+			}
+			if (collapsed)
+			{
+				continue;
+			}
+			const glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+			const glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+			if (glm::dot(n0, n1) <= 0.0f)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+OverdrawStatistics analyzeOverdraw(const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount)
+{
+	OverdrawStatistics statistics;
+	statistics.overdraw = 0.0f;
+	statistics.pixelsCovered = 0;
+	statistics.pixelsShaded = 0;
+	if (indexCount < 3 || vertexCount == 0)
+	{
+		return statistics;
+	}
+
+	glm::vec3 minimum = vertices[0].position;
+	glm::vec3 maximum = vertices[0].position;
+	for (std::size_t i = 1; i < vertexCount; i++)
+	{
+		minimum = glm::min(minimum, vertices[i].position);
+		maximum = glm::max(maximum, vertices[i].position);
+	}
+	const glm::vec3 extent = maximum - minimum;
+	const float largest = std::max(extent.x, std::max(extent.y, extent.z));
+	const float scale = (largest > 0.0f) ? (float)(priv::overdraw_grid_size - 1) / largest : 0.0f;
+
+	std::vector<priv::OverdrawBuffer> buffers(1);
+	priv::OverdrawBuffer& buffer = buffers[0];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int y = 0; y < priv::overdraw_grid_size; y++)
+		{
+			for (int x = 0; x < priv::overdraw_grid_size; x++)
+			{
+				buffer.depth[y][x][0] = buffer.depth[y][x][1] = 1e30f;
+				buffer.shaded[y][x][0] = buffer.shaded[y][x][1] = 0;
+			}
+		}
+
+		const int u = (axis + 1) % 3;
+		const int v = (axis + 2) % 3;
+		for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			glm::vec3 p[3];
+			for (int k = 0; k < 3; k++)
+			{
+				const glm::vec3 position = (vertices[indices[i + k]].position - minimum) * scale;
+				p[k] = glm::vec3(position[u], position[v], position[axis]);
+			}
+			priv::rasterize_overdraw(buffer, p[0], p[1], p[2]);
+		}
+
+		for (int y = 0; y < priv::overdraw_grid_size; y++)
+		{
+			for (int x = 0; x < priv::overdraw_grid_size; x++)
+			{
+				for (int side = 0; side < 2; side++)
+				{
+					statistics.pixelsCovered += (buffer.shaded[y][x][side] > 0) ? 1 : 0;
+					statistics.pixelsShaded += buffer.shaded[y][x][side];
+				}
+			}
+		}
+	}
+
+	if (statistics.pixelsCovered > 0)
+	{
+		statistics.overdraw = (float)statistics.pixelsShaded / (float)statistics.pixelsCovered;
+	}
+	return statistics;
+}
+
+VertexCacheStatistics analyzeVertexCache(const unsigned int* indices, std::size_t indexCount, std::size_t vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStatistics statistics;
+	statistics.acmr = 0.0f;
+	statistics.atvr = 0.0f;
+	statistics.transforms = 0;
+
+	// A vertex is still cached if fewer than cacheSize misses happened since it was last transformed
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	unsigned int time = cacheSize + 1;
+	unsigned int uniqueVertices = 0;
+	for (std::size_t i = 0; i < indexCount; i++)
+	{
+		const unsigned int index = indices[i];
+		if (time - timestamps[index] > cacheSize)
+		{
+			timestamps[index] = time++;
+			statistics.transforms++;
+		}
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			uniqueVertices++;
+		}
+	}
+
+	if (indexCount >= 3)
+	{
+		statistics.acmr = (float)statistics.transforms / (float)(indexCount / 3);
+	}
+	if (uniqueVertices > 0)
+	{
+		statistics.atvr = (float)statistics.transforms / (float)uniqueVertices;
+	}
+	return statistics;
+}
+
+void optimizeVertexCache(unsigned int* indices, std::size_t indexCount, std::size_t vertexCount)
+{
+	static const priv::VertexCacheScores scores;
+
+	const std::size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	const std::vector<unsigned int> source(indices, indices + triangleCount * 3);
+
+	// Vertex -> triangles adjacency, live triangles are kept at the front of each vertex range
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	for (std::size_t i = 0; i < source.size(); i++)
+	{
+		remaining[source[i]]++;
+	}
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (std::size_t v = 0; v < vertexCount; v++)
+	{
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+	std::vector<unsigned int> adjacency(source.size());
+	{
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (std::size_t i = 0; i < source.size(); i++)
+		{
+			adjacency[fill[source[i]]++] = (unsigned int)(i / 3);
+		}
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = scores.get(-1, remaining[v]);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	int bestTriangle = -1;
+	float bestScore = -1.0f;
+	for (std::size_t t = 0; t < triangleCount; t++)
+	{
+		const float score = vertexScores[source[3 * t]] + vertexScores[source[3 * t + 1]] + vertexScores[source[3 * t + 2]];
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = (int)t;
+		}
+	}
+
+	unsigned int cache[priv::vcache_size + 3];
+	unsigned int newCache[priv::vcache_size + 3];
+	int cacheCount = 0;
+	std::size_t inputCursor = 0;
+
+	for (std::size_t output = 0; output < triangleCount; output++)
+	{
+		if (bestTriangle < 0)
+		{
+			// Nothing adjacent to the cache is left : continue with the next triangle in input order
+			while (emitted[inputCursor])
+			{
+				inputCursor++;
+			}
+			bestTriangle = (int)inputCursor;
+		}
+
+		const unsigned int* triangle = &source[3 * bestTriangle];
+		indices[3 * output] = triangle[0];
+		indices[3 * output + 1] = triangle[1];
+		indices[3 * output + 2] = triangle[2];
+		emitted[bestTriangle] = true;
+
+		// Remove the triangle from the adjacency of its vertices
+		for (int k = 0; k < 3; k++)
+		{
+			const unsigned int v = triangle[k];
+			unsigned int* begin = adjacency.data() + offsets[v];
+			for (unsigned int j = 0; j < remaining[v]; j++)
+			{
+				if (begin[j] == (unsigned int)bestTriangle)
+				{
+					begin[j] = begin[remaining[v] - 1];
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// Move the triangle's vertices to the front of the LRU cache
+		int newCacheCount = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			newCache[newCacheCount++] = triangle[k];
+		}
+		for (int i = 0; i < cacheCount; i++)
+		{
+			const unsigned int v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				newCache[newCacheCount++] = v;
+			}
+		}
+
+		// Update scores of every vertex that was touched, including the ones just evicted
+		for (int i = 0; i < newCacheCount; i++)
+		{
+			const unsigned int v = newCache[i];
+			cachePositions[v] = (i < priv::vcache_size) ? i : -1;
+			vertexScores[v] = scores.get(cachePositions[v], remaining[v]);
+		}
+
+		bestTriangle = -1;
+		bestScore = -1.0f;
+		for (int i = 0; i < newCacheCount; i++)
+		{
+			const unsigned int v = newCache[i];
+			const unsigned int* begin = adjacency.data() + offsets[v];
+			for (unsigned int j = 0; j < remaining[v]; j++)
+			{
+				const unsigned int t = begin[j];
+				const float score = vertexScores[source[3 * t]] + vertexScores[source[3 * t + 1]] + vertexScores[source[3 * t + 2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = (int)t;
+				}
+			}
+		}
+
+		cacheCount = (newCacheCount < priv::vcache_size) ? newCacheCount : priv::vcache_size;
+		for (int i = 0; i < cacheCount; i++)
+		{
+			cache[i] = newCache[i];
+		}
+	}
+}
+
+std::size_t weldVertices(Vertex* vertices, std::size_t vertexCount, unsigned int* indices, std::size_t indexCount, float epsilon)
+{
+	if (vertexCount == 0)
+	{
+		return 0;
+	}
+
+	std::size_t capacity = 1;
+	while (capacity < vertexCount + vertexCount / 4)
+	{
+		capacity *= 2;
+	}
+	const unsigned int empty = ~0u;
+	std::vector<unsigned int> remap(vertexCount);
+	if (epsilon > 0.0f)
+	{
+		const std::size_t uniqueCount = priv::weld_near_vertices(vertices, vertexCount, remap, capacity, epsilon);
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			indices[i] = remap[indices[i]];
+		}
+		return uniqueCount;
+	}
+
+	std::vector<unsigned int> table(capacity, empty);
+	std::vector<priv::VertexKey> keys;
+	keys.reserve(vertexCount);
+
+	std::size_t uniqueCount = 0;
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		const priv::VertexKey key = priv::make_vertex_key(vertices[i]);
+		std::size_t slot = priv::hash_vertex_key(key) & (capacity - 1);
+		while (table[slot] != empty && std::memcmp(&keys[table[slot]], &key, sizeof(key)) != 0)
+		{
+			slot = (slot + 1) & (capacity - 1);
+		}
+
+		if (table[slot] == empty)
+		{
+			table[slot] = (unsigned int)uniqueCount;
+			keys.push_back(key);
+			vertices[uniqueCount] = vertices[i];
+			uniqueCount++;
+		}
+		remap[i] = table[slot];
+	}
+
+	for (std::size_t i = 0; i < indexCount; i++)
+	{
+		indices[i] = remap[indices[i]];
+	}
+	return uniqueCount;
+}
+
+std::size_t optimizeVertexFetch(Vertex* vertices, std::size_t vertexCount, unsigned int* indices, std::size_t indexCount)
+{
+	const unsigned int unused = ~0u;
+	std::vector<unsigned int> remap(vertexCount, unused);
+	const std::vector<Vertex> source(vertices, vertices + vertexCount);
+
+	std::size_t nextVertex = 0;
+	for (std::size_t i = 0; i < indexCount; i++)
+	{
+		unsigned int& index = remap[indices[i]];
+		if (index == unused)
+		{
+			index = (unsigned int)nextVertex;
+			vertices[nextVertex++] = source[indices[i]];
+		}
+		indices[i] = index;
+	}
+	return nextVertex;
+}
+
+void optimizeOverdraw(unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, float threshold)
+{
+	const std::size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	unsigned int time = priv::overdraw_cache_size + 1;
+
+	// Hard boundaries : triangles where the simulated cache fully restarts
+	std::vector<unsigned int> hardClusters;
+	for (std::size_t t = 0; t < triangleCount; t++)
+	{
+		if (priv::simulate_cache_misses(&indices[3 * t], timestamps, time) == 3 || t == 0)
+		{
+			hardClusters.push_back((unsigned int)t);
+		}
+	}
+	hardClusters.push_back((unsigned int)triangleCount);
+
+	// Soft boundaries : split each hard cluster as soon as its running ACMR gets close to the cluster's own ACMR
+	std::vector<unsigned int> clusters;
+	for (std::size_t h = 0; h + 1 < hardClusters.size(); h++)
+	{
+		const unsigned int begin = hardClusters[h];
+		const unsigned int end = hardClusters[h + 1];
+
+		time += priv::overdraw_cache_size + 1;
+		unsigned int misses = 0;
+		for (unsigned int t = begin; t < end; t++)
+		{
+			misses += priv::simulate_cache_misses(&indices[3 * t], timestamps, time);
+		}
+		const float acmrThreshold = threshold * (float)misses / (float)(end - begin);
+
+		time += priv::overdraw_cache_size + 1;
+		unsigned int start = begin;
+		misses = 0;
+		clusters.push_back(begin);
+		for (unsigned int t = begin; t < end; t++)
+		{
+			misses += priv::simulate_cache_misses(&indices[3 * t], timestamps, time);
+			if (t + 1 < end && (float)misses <= acmrThreshold * (float)(t + 1 - start))
+			{
+				clusters.push_back(t + 1);
+				start = t + 1;
+				misses = 0;
+				time += priv::overdraw_cache_size + 1;
+			}
+		}
+	}
+	clusters.push_back((unsigned int)triangleCount);
+
+	const std::size_t clusterCount = clusters.size() - 1;
+	std::vector<glm::vec3> centroids(clusterCount);
+	std::vector<glm::vec3> normals(clusterCount);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (std::size_t c = 0; c < clusterCount; c++)
+	{
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float clusterArea = 0.0f;
+		for (unsigned int t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const glm::vec3& p0 = vertices[indices[3 * t]].position;
+			const glm::vec3& p1 = vertices[indices[3 * t + 1]].position;
+			const glm::vec3& p2 = vertices[indices[3 * t + 2]].position;
+			const glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+			const float area = glm::length(faceNormal);
+			centroid += (p0 + p1 + p2) * (area / 3.0f);
+			normal += faceNormal;
+			clusterArea += area;
+		}
+		meshCentroid += centroid;
+		meshArea += clusterArea;
+		centroids[c] = (clusterArea > 0.0f) ? centroid / clusterArea : vertices[indices[3 * clusters[c]]].position;
+		const float length = glm::length(normal);
+		normals[c] = (length > 0.0f) ? normal / length : glm::vec3(0.0f);
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	// Clusters far out along their own normal are likely to occlude the rest from most view directions
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<unsigned int> order(clusterCount);
+	for (std::size_t c = 0; c < clusterCount; c++)
+	{
+		sortKeys[c] = glm::dot(centroids[c] - meshCentroid, normals[c]);
+		order[c] = (unsigned int)c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](unsigned int a, unsigned int b)
+	{
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	const std::vector<unsigned int> source(indices, indices + triangleCount * 3);
+	std::size_t output = 0;
+	for (std::size_t i = 0; i < clusterCount; i++)
+	{
+		const unsigned int c = order[i];
+		for (unsigned int j = 3 * clusters[c]; j < 3 * clusters[c + 1]; j++)
+		{
+			indices[output++] = source[j];
+		}
+	}
+}
+
+std::size_t buildMeshlets(const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, std::vector<Meshlet>& meshlets, std::size_t maxVertices, std::size_t maxTriangles)
+{
+	const std::size_t first = meshlets.size();
+	if (indexCount < 3 || vertexCount == 0 || maxVertices < 3 || maxTriangles == 0)
+	{
+		return 0;
+	}
+
+	// Unique vertices of the open meshlet, a linear search over at most maxVertices entries beats a hash here
+	std::vector<unsigned int> used;
+	used.reserve(maxVertices);
+	std::size_t start = 0;
+	const std::size_t end = indexCount - indexCount % 3;
+	for (std::size_t i = 0; i < end; i += 3)
+	{
+		std::size_t added = 0;
+		for (std::size_t k = 0; k < 3; k++)
+		{
+			if (std::find(used.begin(), used.end(), indices[i + k]) == used.end() && std::find(indices + i, indices + i + k, indices[i + k]) == indices + i + k)
+			{
+				added++;
+			}
+		}
+
+		if (used.size() + added > maxVertices || (i - start) / 3 >= maxTriangles)
+		{
+			meshlets.push_back(priv::make_meshlet(indices, start, i - start, vertices));
+			start = i;
+			used.clear();
+		}
+
+		for (std::size_t k = 0; k < 3; k++)
+		{
+			if (std::find(used.begin(), used.end(), indices[i + k]) == used.end())
+			{
+				used.push_back(indices[i + k]);
+			}
+		}
+	}
+	meshlets.push_back(priv::make_meshlet(indices, start, end - start, vertices));
+
+	return meshlets.size() - first;
+}
+
+std::size_t simplifyMesh(unsigned int* destination, const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, std::size_t targetIndexCount, float targetError, float* resultError)
+{
+	if (resultError != nullptr)
+	{
+		*resultError = 0.0f;
+	}
+	indexCount -= indexCount % 3;
+	std::copy(indices, indices + indexCount, destination);
+	if (indexCount == 0 || vertexCount == 0)
+	{
+		return indexCount;
+	}
+
+	// Positions scaled to the unit cube, so errors are relative to the mesh extent
+	glm::vec3 minimum = vertices[0].position;
+	glm::vec3 maximum = vertices[0].position;
+	for (std::size_t i = 1; i < vertexCount; i++)
+	{
+		minimum = glm::min(minimum, vertices[i].position);
+		maximum = glm::max(maximum, vertices[i].position);
+	}
+	const glm::vec3 size = maximum - minimum;
+	const float extent = std::max(size.x, std::max(size.y, size.z));
+	const float scale = (extent > 0.0f) ? 1.0f / extent : 1.0f;
+	std::vector<glm::vec3> positions(vertexCount);
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		positions[i] = (vertices[i].position - minimum) * scale;
+	}
+
+	// remap : first vertex at the same position, wedge : next vertex at the same position, circular
+	std::vector<unsigned int> order(vertexCount);
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		order[i] = (unsigned int)i;
+	}
+	std::sort(order.begin(), order.end(), [vertices](unsigned int a, unsigned int b)
+	{
+		const glm::vec3& pa = vertices[a].position;
+		const glm::vec3& pb = vertices[b].position;
+		return (pa.x != pb.x) ? pa.x < pb.x : (pa.y != pb.y) ? pa.y < pb.y : pa.z < pb.z;
+	});
+	std::vector<unsigned int> identity(vertexCount);
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<unsigned int> wedge(vertexCount);
+	for (std::size_t start = 0; start < vertexCount;)
+	{
+		std::size_t end = start + 1;
+		while (end < vertexCount && vertices[order[end]].position == vertices[order[start]].position)
+		{
+			end++;
+		}
+		for (std::size_t i = start; i < end; i++)
+		{
+			remap[order[i]] = order[start];
+			wedge[order[i]] = order[(i + 1 < end) ? i + 1 : start];
+		}
+		start = end;
+	}
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		identity[i] = (unsigned int)i;
+	}
+
+	// Borders are open edges between positions, seams are open edges between vertices that close once positions are merged
+	priv::EdgeAdjacency attributeEdges;
+	priv::EdgeAdjacency positionEdges;
+	attributeEdges.build(destination, indexCount, identity.data(), vertexCount);
+	positionEdges.build(destination, indexCount, remap.data(), vertexCount);
+	std::vector<unsigned int> attributeOut, attributeIn, positionOut, positionIn;
+	attributeEdges.countOpenEdges(attributeOut, attributeIn);
+	positionEdges.countOpenEdges(positionOut, positionIn);
+
+	std::vector<unsigned char> kinds(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; v++)
+	{
+		const unsigned int p = remap[v];
+		const unsigned int w = wedge[v];
+		if (w == v)
+		{
+			if (attributeOut[v] == 0 && attributeIn[v] == 0)
+			{
+				kinds[v] = priv::Manifold;
+			}
+			else if (attributeOut[v] == 1 && attributeIn[v] == 1 && positionOut[p] == 1 && positionIn[p] == 1)
+			{
+				kinds[v] = priv::Border;
+			}
+			else
+			{
+				kinds[v] = priv::Locked;
+			}
+		}
+		else if (wedge[w] == v && positionOut[p] == 0 && positionIn[p] == 0
+			&& attributeOut[v] == 1 && attributeIn[v] == 1 && attributeOut[w] == 1 && attributeIn[w] == 1)
+		{
+			kinds[v] = priv::Seam;
+		}
+		else
+		{
+			kinds[v] = priv::Locked;
+		}
+	}
+
+	std::vector<priv::Quadric> quadrics(vertexCount, priv::make_plane_quadric(glm::vec3(0.0f), 0.0f, 0.0f));
+	for (std::size_t i = 0; i < indexCount; i += 3)
+	{
+		const unsigned int* triangle = destination + i;
+		const glm::vec3& p0 = positions[triangle[0]];
+		glm::vec3 normal = glm::cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0);
+		const float area = glm::length(normal);
+		if (area == 0.0f)
+		{
+			continue;
+		}
+		normal /= area;
+		const priv::Quadric face = priv::make_plane_quadric(normal, -glm::dot(normal, p0), area);
+		for (int k = 0; k < 3; k++)
+		{
+			priv::add_quadric(quadrics[remap[triangle[k]]], face);
+		}
+
+		// Open borders get a plane perpendicular to the face, so they keep their outline
+		for (int k = 0; k < 3; k++)
+		{
+			const unsigned int a = remap[triangle[k]];
+			const unsigned int b = remap[triangle[(k + 1) % 3]];
+			if (positionEdges.has(b, a))
+			{
+				continue;
+			}
+			const glm::vec3 edge = positions[b] - positions[a];
+			glm::vec3 perpendicular = glm::cross(edge, normal);
+			const float length = glm::length(perpendicular);
+			if (length > 0.0f)
+			{
+				perpendicular /= length;
+				const priv::Quadric border = priv::make_plane_quadric(perpendicular, -glm::dot(perpendicular, positions[a]), glm::dot(edge, edge) * priv::simplify_border_weight);
+				priv::add_quadric(quadrics[a], border);
+				priv::add_quadric(quadrics[b], border);
+			}
+		}
+	}
+
+	const std::size_t targetTriangles = targetIndexCount / 3;
+	const float errorLimit = targetError * targetError;
+	float maxError = 0.0f;
+	std::vector<priv::Collapse> collapses;
+	std::vector<unsigned int> collapseRemap(vertexCount);
+	std::vector<unsigned char> locked(vertexCount);
+	std::vector<unsigned int> triangleOffsets;
+	std::vector<unsigned int> triangles;
+	while (indexCount / 3 > targetTriangles)
+	{
+		const std::size_t triangleCount = indexCount / 3;
+		attributeEdges.build(destination, indexCount, identity.data(), vertexCount);
+		positionEdges.build(destination, indexCount, remap.data(), vertexCount);
+
+		// Triangles around every position
+		triangleOffsets.assign(vertexCount + 1, 0);
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			triangleOffsets[remap[destination[i]] + 1]++;
+		}
+		for (std::size_t v = 0; v < vertexCount; v++)
+		{
+			triangleOffsets[v + 1] += triangleOffsets[v];
+		}
+		triangles.resize(indexCount);
+		std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			triangles[fill[remap[destination[i]]]++] = (unsigned int)(i / 3);
+		}
+
+		// Candidates in both directions of every edge, restricted by the kind of the moving vertex
+		collapses.clear();
+		for (std::size_t i = 0; i < indexCount; i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				const unsigned int a = destination[i + k];
+				const unsigned int b = destination[i + (k + 1) % 3];
+				const bool border = !positionEdges.has(remap[b], remap[a]);
+				const bool seam = !attributeEdges.has(b, a);
+				for (int direction = 0; direction < 2; direction++)
+				{
+					const unsigned int from = (direction == 0) ? a : b;
+					const unsigned int to = (direction == 0) ? b : a;
+					bool allowed = false;
+					switch (kinds[from])
+					{
+						case priv::Manifold: allowed = true; break;
+						case priv::Border: allowed = border && (kinds[to] == priv::Border || kinds[to] == priv::Locked); break;
+						case priv::Seam: allowed = seam && !border && (kinds[to] == priv::Seam || kinds[to] == priv::Locked); break;
+						default: break;
+					}
+					if (allowed)
+					{
+						priv::Collapse collapse;
+						collapse.from = from;
+						collapse.to = to;
+						collapse.error = priv::quadric_error(quadrics[remap[from]], positions[to]);
+						collapses.push_back(collapse);
+					}
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const priv::Collapse& a, const priv::Collapse& b)
+		{
+			return a.error < b.error;
+		});
+
+		// Cheapest collapses first, at most one per neighbourhood so the flip test stays exact
+		// Each collapse removes about two triangles, the pass stops well before reaching much costlier ones (meshoptimizer's error goal)
+		const std::size_t collapseGoal = std::max<std::size_t>((triangleCount - targetTriangles) / 2, 1);
+		const float passErrorLimit = (collapseGoal < collapses.size()) ? std::min(errorLimit, 1.5f * collapses[collapseGoal - 1].error) : errorLimit;
+		for (std::size_t v = 0; v < vertexCount; v++)
+		{
+			collapseRemap[v] = (unsigned int)v;
+		}
+		std::fill(locked.begin(), locked.end(), 0);
+		std::size_t removed = 0;
+		std::size_t collapsed = 0;
+		for (std::size_t c = 0; c < collapses.size() && triangleCount - removed > targetTriangles; c++)
+		{
+			const priv::Collapse& collapse = collapses[c];
+			if (collapse.error > passErrorLimit)
+			{
+				break;
+			}
+			const unsigned int from = remap[collapse.from];
+			const unsigned int to = remap[collapse.to];
+			if (locked[from] || locked[to] || priv::has_triangle_flip(destination, triangles, triangleOffsets, positions, remap.data(), collapse.from, collapse.to))
+			{
+				continue;
+			}
+
+			// The twin of a seam vertex follows along the other side of the seam
+			if (kinds[collapse.from] == priv::Seam)
+			{
+				const unsigned int twin = wedge[collapse.from];
+				unsigned int twinTarget = ~0u;
+				for (unsigned int i = triangleOffsets[from]; i < triangleOffsets[from + 1] && twinTarget == ~0u; i++)
+				{
+					const unsigned int* triangle = destination + 3 * triangles[i];
+					if (triangle[0] != twin && triangle[1] != twin && triangle[2] != twin)
+					{
+						continue;
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						if (remap[triangle[k]] == to)
+						{
+							twinTarget = triangle[k];
+						}
+					}
+				}
+				if (twinTarget == ~0u)
+				{
+					continue;
+				}
+				collapseRemap[twin] = twinTarget;
+			}
+			collapseRemap[collapse.from] = collapse.to;
+			priv::add_quadric(quadrics[to], quadrics[from]);
+
+			for (unsigned int i = triangleOffsets[from]; i < triangleOffsets[from + 1]; i++)
+			{
+				const unsigned int* triangle = destination + 3 * triangles[i];
+				bool shared = false;
+				for (int k = 0; k < 3; k++)
+				{
+					locked[remap[triangle[k]]] = 1;
+					shared |= (remap[triangle[k]] == to);
+				}
+				removed += shared ? 1 : 0;
+			}
+			maxError = std::max(maxError, collapse.error);
+			collapsed++;
+		}
+		if (collapsed == 0)
+		{
+			break;
+		}
+
+		std::size_t write = 0;
+		for (std::size_t i = 0; i < indexCount; i += 3)
+		{
+			const unsigned int a = collapseRemap[destination[i]];
+			const unsigned int b = collapseRemap[destination[i + 1]];
+			const unsigned int c = collapseRemap[destination[i + 2]];
+			if (remap[a] != remap[b] && remap[b] != remap[c] && remap[c] != remap[a])
+			{
+				destination[write++] = a;
+				destination[write++] = b;
+				destination[write++] = c;
+			}
+		}
+		indexCount = write;
+	}
+
+	if (resultError != nullptr)
+	{
+		*resultError = std::sqrt(maxError);
+	}
+	return indexCount;
+}
+
+namespace priv
+{
+	const std::size_t tangent_min_items_per_thread = 16384;
+
+	struct CornerTangent
+	{
+		glm::vec3 tangent;
+		glm::vec3 bitangent;
+	};
+
+	// Runs function(first, last) over contiguous ranges of [0, count) on up to every hardware thread
+	template <typename Function>
+	void parallel_for(std::size_t count, Function function)
+	{
+		const std::size_t threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / tangent_min_items_per_thread + 1);
+		std::vector<std::thread> threads;
+		for (std::size_t i = 1; i < threadCount; i++)
+		{
+			threads.push_back(std::thread(function, count * i / threadCount, count * (i + 1) / threadCount));
+		}
+		function(0, count / threadCount);
+		for (std::size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i].join();
+		}
+	}
+
+	float corner_angle(const glm::vec3& a, const glm::vec3& b)
+	{
+		const float lengths = glm::length(a) * glm::length(b);
+		return (lengths > 0.0f) ? std::acos(glm::clamp(glm::dot(a, b) / lengths, -1.0f, 1.0f)) : 0.0f;
+	}
+
+	void compute_corner_tangents(const unsigned int* indices, const Vertex* vertices, CornerTangent* corners, std::size_t first, std::size_t last)
+	{
+		for (std::size_t t = first; t < last; t++)
+		{
+			const unsigned int* triangle = indices + 3 * t;
+			const Vertex& v0 = vertices[triangle[0]];
+			const Vertex& v1 = vertices[triangle[1]];
+			const Vertex& v2 = vertices[triangle[2]];
+			const glm::vec3 e1 = v1.position - v0.position;
+			const glm::vec3 e2 = v2.position - v0.position;
+			const glm::vec2 d1 = v1.uv - v0.uv;
+			const glm::vec2 d2 = v2.uv - v0.uv;
+
+			// Directions of increasing s and t, flipped with the sign of the UV area as MikkTSpace does, then normalized
+			const float area = d1.x * d2.y - d2.x * d1.y;
+			const float sign = (area < 0.0f) ? -1.0f : 1.0f;
+			glm::vec3 tangent = (e1 * d2.y - e2 * d1.y) * sign;
+			glm::vec3 bitangent = (e2 * d1.x - e1 * d2.x) * sign;
+			const float tangentLength = glm::length(tangent);
+			const float bitangentLength = glm::length(bitangent);
+			const bool degenerate = (area == 0.0f || tangentLength <= 0.0f || bitangentLength <= 0.0f);
+			tangent = degenerate ? glm::vec3(0.0f) : tangent / tangentLength;
+			bitangent = degenerate ? glm::vec3(0.0f) : bitangent / bitangentLength;
+
+			const glm::vec3 p[3] = { v0.position, v1.position, v2.position };
+			for (int k = 0; k < 3; k++)
+			{
+				const float weight = corner_angle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+				corners[3 * t + k].tangent = tangent * weight;
+				corners[3 * t + k].bitangent = bitangent * weight;
+			}
+		}
+	}
+
+	glm::vec3 any_perpendicular(const glm::vec3& normal)
+	{
+		const glm::vec3 axis = (glm::abs(normal.x) < 0.9f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		const glm::vec3 tangent = axis - normal * glm::dot(normal, axis);
+		return glm::normalize(tangent);
+	}
+}
+
+void generateTangents(const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, glm::vec4* tangents)
+{
+	const std::size_t triangleCount = indexCount / 3;
+	std::vector<priv::CornerTangent> corners(triangleCount * 3);
+	priv::parallel_for(triangleCount, [&](std::size_t first, std::size_t last)
+	{
+		priv::compute_corner_tangents(indices, vertices, corners.data(), first, last);
+	});
+
+	// Corners of every vertex, in index order
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (std::size_t i = 0; i < triangleCount * 3; i++)
+	{
+		offsets[indices[i] + 1]++;
+	}
+	for (std::size_t v = 0; v < vertexCount; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+	std::vector<unsigned int> vertexCorners(triangleCount * 3);
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (std::size_t i = 0; i < triangleCount * 3; i++)
+	{
+		vertexCorners[fill[indices[i]]++] = (unsigned int)i;
+	}
+
+	priv::parallel_for(vertexCount, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t v = first; v < last; v++)
+		{
+			glm::vec3 tangent(0.0f);
+			glm::vec3 bitangent(0.0f);
+			for (unsigned int c = offsets[v]; c < offsets[v + 1]; c++)
+			{
+				tangent += corners[vertexCorners[c]].tangent;
+				bitangent += corners[vertexCorners[c]].bitangent;
+			}
+
+			const glm::vec3& normal = vertices[v].normal;
+			tangent -= normal * glm::dot(normal, tangent);
+			const float length = glm::length(tangent);
+			tangent = (length > 1e-12f) ? tangent / length : priv::any_perpendicular(normal);
+			const float handedness = (glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f) ? -1.0f : 1.0f;
+			tangents[v] = glm::vec4(tangent, handedness);
+		}
+	});
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Vertex.hpp"
+
+namespace cmgl
+{
+
+struct OverdrawStatistics
+{
+	float overdraw; // shaded fragments per covered pixel (1.0 best)
+	unsigned int pixelsCovered;
+	unsigned int pixelsShaded;
+};
+
+// Cluster of triangles contiguous in the index buffer, with the bounds used for CPU culling
+// A cluster faces away from the camera when dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius
+struct Meshlet
+{
+	glm::vec3 center;
+	float radius;
+	glm::vec3 coneAxis;
+	float coneCutoff; // sine of the cone half angle, 1.0 when the cluster can not be back-face culled
+	unsigned int indexOffset;
+	unsigned int indexCount;
+	unsigned int baseVertex;
+	unsigned int subMesh;
+};
+
+struct VertexCacheStatistics
+{
+	float acmr; // transformed vertices per triangle (0.5 best, 3.0 worst)
+	float atvr; // transformed vertices per referenced vertex (1.0 best)
+	unsigned int transforms;
+};
+
+// Simulates a FIFO post-transform cache of the given size over a triangle list
+VertexCacheStatistics analyzeVertexCache(const unsigned int* indices, std::size_t indexCount, std::size_t vertexCount, unsigned int cacheSize = 16);
+
+// Rasterizes the mesh along the six axis directions in software with back face culling and a depth test, and counts shaded fragments
+OverdrawStatistics analyzeOverdraw(const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount);
+
+// Reorders triangles in place for the post-transform vertex cache (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+void optimizeVertexCache(unsigned int* indices, std::size_t indexCount, std::size_t vertexCount);
+
+// Merges duplicated vertices with a hash table and remaps the indices, returns the new vertex count
+// Positions, UVs and normals are compared bit for bit, or merged when every component differs by at most epsilon when epsilon > 0
+std::size_t weldVertices(Vertex* vertices, std::size_t vertexCount, unsigned int* indices, std::size_t indexCount, float epsilon = 0.0f);
+
+// Reorders vertices by first use in the index stream and drops unreferenced ones, returns the new vertex count
+std::size_t optimizeVertexFetch(Vertex* vertices, std::size_t vertexCount, unsigned int* indices, std::size_t indexCount);
+
+// Splits a vertex cache optimized index buffer into clusters and sorts them so outer, outward-facing geometry is drawn first
+// Clusters are cut where the cache restarts or where the local ACMR stays under threshold times the global one
+// (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+void optimizeOverdraw(unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, float threshold = 1.05f);
+
+// Cuts the triangle list in order into meshlets of at most maxVertices unique vertices and maxTriangles triangles, and appends them
+// Run it after optimizeVertexCache so consecutive triangles share vertices, returns the number of meshlets appended
+std::size_t buildMeshlets(const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, std::vector<Meshlet>& meshlets, std::size_t maxVertices = 64, std::size_t maxTriangles = 124);
+
+// Collapses edges by increasing quadric error until at most targetIndexCount indices remain or the error would exceed targetError
+// Vertices only move onto their neighbours so every level can share the source vertex buffer, borders and UV / normal seams are kept
+// Errors are relative to the mesh extent, the reached one is written to resultError, returns the new index count
+std::size_t simplifyMesh(unsigned int* destination, const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, std::size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+// Per-vertex tangents following MikkTSpace : corner angle weighted triangle tangents orthogonalized against the normal, bitangent sign in w
+// Vertices are not split, so frames only match MikkTSpace exactly where mirrored UVs already have a seam
+// Triangle ranges run on every hardware thread and corners are summed in index order, the result does not depend on the thread count
+void generateTangents(const unsigned int* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount, glm::vec4* tangents);
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "ObjLoader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "MappedFile.hpp"
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const std::size_t obj_min_chunk_size = 1 << 20;
+
+	// Attribute indices of a face corner, -1 when missing
+	// Negative OBJ indices count back from the chunk's own elements, they are flagged and resolved once every chunk is parsed
+	struct ObjCorner
+	{
+		int indices[3];
+		unsigned int relative;
+	};
+
+	struct ObjMaterial
+	{
+		std::size_t firstCorner;
+		std::string name;
+	};
+
+	struct ObjChunk
+	{
+		const char* begin;
+		const char* end;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+		std::vector<ObjCorner> corners; // 3 per triangle
+		std::vector<ObjMaterial> materials;
+		bool valid;
+	};
+
+	bool is_obj_space(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	const char* skip_obj_spaces(const char* p, const char* end)
+	{
+		while (p < end && is_obj_space(*p))
+		{
+			p++;
+		}
+		return p;
+	}
+
+	bool starts_obj_keyword(const char* p, const char* end, const char* keyword, std::size_t length)
+	{
+		return (std::size_t)(end - p) > length && std::memcmp(p, keyword, length) == 0 && is_obj_space(p[length]);
+	}
+
+	// Locale independent decimal parser, 19 significant digits scaled by an exact power of ten
+	const char* parse_obj_float(const char* p, const char* end, float& value)
+	{
+		static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		p = skip_obj_spaces(p, end);
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negative = (*p == '-');
+			p++;
+		}
+
+		std::uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += (mantissa != 0) ? 1 : 0;
+			}
+			else
+			{
+				exponent++;
+			}
+			p++;
+		}
+		if (p < end && *p == '.')
+		{
+			p++;
+			while (p < end && *p >= '0' && *p <= '9')
+			{
+				if (digits < 19)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					digits += (mantissa != 0) ? 1 : 0;
+					exponent--;
+				}
+				p++;
+			}
+		}
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			p++;
+			bool negativeExponent = false;
+			if (p < end && (*p == '-' || *p == '+'))
+			{
+				negativeExponent = (*p == '-');
+				p++;
+			}
+			int e = 0;
+			while (p < end && *p >= '0' && *p <= '9')
+			{
+				e = std::min(e * 10 + (*p - '0'), 1000);
+				p++;
+			}
+			exponent += negativeExponent ? -e : e;
+		}
+
+		double result = (double)mantissa;
+		if (exponent < 0)
+		{
+			result = (-exponent <= 22) ? result / powers[-exponent] : result * std::pow(10.0, exponent);
+		}
+		else if (exponent > 0)
+		{
+			result = (exponent <= 22) ? result * powers[exponent] : result * std::pow(10.0, exponent);
+		}
+		value = (float)(negative ? -result : result);
+		return p;
+	}
+
+	const char* parse_obj_index(const char* p, const char* end, int count, int& index, unsigned int& relative, unsigned int bit)
+	{
+		bool negative = false;
+		if (p < end && *p == '-')
+		{
+			negative = true;
+			p++;
+		}
+		int value = 0;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			value = value * 10 + (*p - '0');
+			p++;
+		}
+		if (value == 0)
+		{
+			index = -1;
+		}
+		else if (negative)
+		{
+			index = count - value;
+			relative |= bit;
+		}
+		else
+		{
+			index = value - 1;
+		}
+		return p;
+	}
+
+	void parse_obj_chunk(ObjChunk& chunk)
+	{
+		std::vector<ObjCorner> polygon;
+		const char* p = chunk.begin;
+		while (p < chunk.end)
+		{
+			// memchr is vectorized by every mainstream C library, that is our SIMD newline scan
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+			if (lineEnd == nullptr)
+			{
+				lineEnd = chunk.end;
+			}
+			p = skip_obj_spaces(p, lineEnd);
+
+			if (starts_obj_keyword(p, lineEnd, "v", 1))
+			{
+				glm::vec3 position;
+				p = parse_obj_float(p + 1, lineEnd, position.x);
+				p = parse_obj_float(p, lineEnd, position.y);
+				p = parse_obj_float(p, lineEnd, position.z);
+				chunk.positions.push_back(position);
+			}
+			else if (starts_obj_keyword(p, lineEnd, "vt", 2))
+			{
+				glm::vec2 uv;
+				p = parse_obj_float(p + 2, lineEnd, uv.x);
+				p = parse_obj_float(p, lineEnd, uv.y);
+				chunk.uvs.push_back(uv);
+			}
+			else if (starts_obj_keyword(p, lineEnd, "vn", 2))
+			{
+				glm::vec3 normal;
+				p = parse_obj_float(p + 2, lineEnd, normal.x);
+				p = parse_obj_float(p, lineEnd, normal.y);
+				p = parse_obj_float(p, lineEnd, normal.z);
+				chunk.normals.push_back(normal);
+			}
+			else if (starts_obj_keyword(p, lineEnd, "f", 1))
+			{
+				polygon.clear();
+				p = skip_obj_spaces(p + 1, lineEnd);
+				while (p < lineEnd)
+				{
+					ObjCorner corner;
+					corner.relative = 0;
+					corner.indices[1] = -1;
+					corner.indices[2] = -1;
+					const char* start = p;
+					p = parse_obj_index(p, lineEnd, (int)chunk.positions.size(), corner.indices[0], corner.relative, 1);
+					if (p < lineEnd && *p == '/')
+					{
+						p = parse_obj_index(p + 1, lineEnd, (int)chunk.uvs.size(), corner.indices[1], corner.relative, 2);
+						if (p < lineEnd && *p == '/')
+						{
+							p = parse_obj_index(p + 1, lineEnd, (int)chunk.normals.size(), corner.indices[2], corner.relative, 4);
+						}
+					}
+					if (p == start || (corner.indices[0] == -1 && (corner.relative & 1) == 0))
+					{
+						chunk.valid = false;
+						return;
+					}
+					polygon.push_back(corner);
+					p = skip_obj_spaces(p, lineEnd);
+				}
+				for (std::size_t i = 2; i < polygon.size(); i++)
+				{
+					chunk.corners.push_back(polygon[0]);
+					chunk.corners.push_back(polygon[i - 1]);
+					chunk.corners.push_back(polygon[i]);
+				}
+			}
+			else if (starts_obj_keyword(p, lineEnd, "usemtl", 6))
+			{
+				const char* name = skip_obj_spaces(p + 6, lineEnd);
+				const char* nameEnd = lineEnd;
+				while (nameEnd > name && is_obj_space(nameEnd[-1]))
+				{
+					nameEnd--;
+				}
+				ObjMaterial material;
+				material.firstCorner = chunk.corners.size();
+				material.name.assign(name, nameEnd);
+				chunk.materials.push_back(material);
+			}
+
+			p = lineEnd + 1;
+		}
+	}
+
+	// Turns chunk-local relative indices into global ones, and checks every index
+	bool resolve_obj_chunk(ObjChunk& chunk, const std::size_t bases[3], const std::size_t counts[3])
+	{
+		for (std::size_t i = 0; i < chunk.corners.size(); i++)
+		{
+			ObjCorner& corner = chunk.corners[i];
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				if ((corner.relative & (1u << k)) != 0)
+				{
+					corner.indices[k] += (int)bases[k];
+					if (corner.indices[k] < 0)
+					{
+						return false;
+					}
+				}
+				if (corner.indices[k] >= (int)counts[k])
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	std::uint32_t hash_obj_corner(const ObjCorner& corner)
+	{
+		std::uint32_t hash = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			// MurmurHash2 mixing step
+			std::uint32_t h = (std::uint32_t)corner.indices[k] * 0x5BD1E995u;
+			h ^= h >> 24;
+			h *= 0x5BD1E995u;
+			hash = (hash * 0x5BD1E995u) ^ h;
+		}
+		return hash;
+	}
+}
+
+bool loadObj(const std::string& filename, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<SubMesh>& subMeshes)
+{
+	vertices.clear();
+	indices.clear();
+	subMeshes.clear();
+
+	MappedFile file;
+	if (!file.open(filename))
+	{
+		fprintf(stderr, "Failed to open mesh : %s\n", filename.c_str());
+		return false;
+	}
+	const char* data = reinterpret_cast<const char*>(file.getData());
+	const std::size_t size = file.getSize();
+
+	// Chunks start right after a newline, so no line is split between two threads
+	const std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	const std::size_t chunkCount = std::min(threadCount, size / priv::obj_min_chunk_size + 1);
+	std::vector<priv::ObjChunk> chunks(chunkCount);
+	const char* begin = data;
+	for (std::size_t i = 0; i < chunkCount; i++)
+	{
+		const char* end = data + size;
+		if (i + 1 < chunkCount)
+		{
+			const char* target = std::max(begin, data + size * (i + 1) / chunkCount);
+			const char* newline = static_cast<const char*>(std::memchr(target, '\n', data + size - target));
+			end = (newline != nullptr) ? newline + 1 : data + size;
+		}
+		chunks[i].begin = begin;
+		chunks[i].end = end;
+		chunks[i].valid = true;
+		begin = end;
+	}
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < chunkCount; i++)
+	{
+		threads.push_back(std::thread(priv::parse_obj_chunk, std::ref(chunks[i])));
+	}
+	priv::parse_obj_chunk(chunks[0]);
+	for (std::size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	// Concatenate the attributes, chunk bases resolve the relative indices
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<std::size_t> bases(3 * chunkCount);
+	for (std::size_t i = 0; i < chunkCount; i++)
+	{
+		if (!chunks[i].valid)
+		{
+			fprintf(stderr, "Invalid face in OBJ file : %s\n", filename.c_str());
+			return false;
+		}
+		bases[3 * i + 0] = positions.size();
+		bases[3 * i + 1] = uvs.size();
+		bases[3 * i + 2] = normals.size();
+		positions.insert(positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+		uvs.insert(uvs.end(), chunks[i].uvs.begin(), chunks[i].uvs.end());
+		normals.insert(normals.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+	}
+	const std::size_t counts[3] = { positions.size(), uvs.size(), normals.size() };
+	for (std::size_t i = 0; i < chunkCount; i++)
+	{
+		if (!priv::resolve_obj_chunk(chunks[i], &bases[3 * i], counts))
+		{
+			fprintf(stderr, "Face index out of range in OBJ file : %s\n", filename.c_str());
+			return false;
+		}
+	}
+
+	// Corner ranges per material, materials numbered by first use
+	struct CornerRange
+	{
+		const priv::ObjCorner* begin;
+		const priv::ObjCorner* end;
+	};
+	std::vector<std::string> materialNames(1);
+	std::vector<std::vector<CornerRange>> materialRanges(1);
+	std::size_t material = 0;
+	for (std::size_t i = 0; i < chunkCount; i++)
+	{
+		const priv::ObjChunk& chunk = chunks[i];
+		std::size_t start = 0;
+		for (std::size_t m = 0; m <= chunk.materials.size(); m++)
+		{
+			const std::size_t end = (m < chunk.materials.size()) ? chunk.materials[m].firstCorner : chunk.corners.size();
+			if (end > start)
+			{
+				CornerRange range;
+				range.begin = chunk.corners.data() + start;
+				range.end = chunk.corners.data() + end;
+				materialRanges[material].push_back(range);
+			}
+			if (m < chunk.materials.size())
+			{
+				material = std::find(materialNames.begin(), materialNames.end(), chunk.materials[m].name) - materialNames.begin();
+				if (material == materialNames.size())
+				{
+					materialNames.push_back(chunk.materials[m].name);
+					materialRanges.resize(materialNames.size());
+				}
+			}
+			start = end;
+		}
+	}
+
+	// Weld identical corners per sub-mesh, indices stay local to the sub-mesh
+	std::vector<unsigned int> table;
+	std::vector<priv::ObjCorner> keys;
+	for (std::size_t m = 0; m < materialRanges.size(); m++)
+	{
+		std::size_t cornerCount = 0;
+		for (std::size_t r = 0; r < materialRanges[m].size(); r++)
+		{
+			cornerCount += materialRanges[m][r].end - materialRanges[m][r].begin;
+		}
+		if (cornerCount == 0)
+		{
+			continue;
+		}
+
+		SubMesh subMesh;
+		subMesh.indexOffset = (unsigned int)indices.size();
+		subMesh.indexCount = (unsigned int)cornerCount;
+		subMesh.baseVertex = (unsigned int)vertices.size();
+		subMesh.materialIndex = (unsigned int)m;
+
+		std::size_t capacity = 1;
+		while (capacity < cornerCount + cornerCount / 4)
+		{
+			capacity *= 2;
+		}
+		const unsigned int empty = ~0u;
+		table.assign(capacity, empty);
+		keys.clear();
+		bool missingNormals = false;
+		indices.reserve(indices.size() + cornerCount);
+		for (std::size_t r = 0; r < materialRanges[m].size(); r++)
+		{
+			for (const priv::ObjCorner* corner = materialRanges[m][r].begin; corner != materialRanges[m][r].end; corner++)
+			{
+				std::size_t slot = priv::hash_obj_corner(*corner) & (capacity - 1);
+				while (table[slot] != empty && std::memcmp(keys[table[slot]].indices, corner->indices, sizeof(corner->indices)) != 0)
+				{
+					slot = (slot + 1) & (capacity - 1);
+				}
+				if (table[slot] == empty)
+				{
+					table[slot] = (unsigned int)keys.size();
+					keys.push_back(*corner);
+					const glm::vec2 uv = (corner->indices[1] >= 0) ? uvs[corner->indices[1]] : glm::vec2(0.0f);
+					const glm::vec3 normal = (corner->indices[2] >= 0) ? normals[corner->indices[2]] : glm::vec3(0.0f);
+					missingNormals |= (corner->indices[2] < 0);
+					vertices.push_back(Vertex(positions[corner->indices[0]], uv, normal));
+				}
+				indices.push_back(table[slot]);
+			}
+		}
+
+		if (missingNormals)
+		{
+			Vertex* subVertices = vertices.data() + subMesh.baseVertex;
+			const unsigned int* subIndices = indices.data() + subMesh.indexOffset;
+			for (std::size_t i = 0; i < cornerCount; i += 3)
+			{
+				const glm::vec3& p0 = subVertices[subIndices[i]].position;
+				const glm::vec3 normal = glm::cross(subVertices[subIndices[i + 1]].position - p0, subVertices[subIndices[i + 2]].position - p0);
+				for (int k = 0; k < 3; k++)
+				{
+					if (keys[subIndices[i + k]].indices[2] < 0)
+					{
+						subVertices[subIndices[i + k]].normal += normal;
+					}
+				}
+			}
+			for (std::size_t v = 0; v < keys.size(); v++)
+			{
+				const float length = glm::length(subVertices[v].normal);
+				if (keys[v].indices[2] < 0)
+				{
+					subVertices[v].normal = (length > 0.0f) ? subVertices[v].normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+				}
+			}
+		}
+
+		subMeshes.push_back(subMesh);
+	}
+
+	if (subMeshes.empty())
+	{
+		fprintf(stderr, "No faces in OBJ file : %s\n", filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+} // namespace cmgl
\ No newline at end of file
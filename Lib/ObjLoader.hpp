@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SubMesh.hpp"
+#include "Vertex.hpp"
+
+namespace cmgl
+{
+
+// Native Wavefront OBJ reader, used by Mesh::loadFromFile instead of Assimp for .obj files
+// The file is memory-mapped and cut into line-aligned chunks that are parsed on every hardware thread
+// Polygons are fan triangulated, each material becomes a sub-mesh and identical v/vt/vn corners are welded
+// Vertices without a normal get the area-weighted average of their faces' normals
+bool loadObj(const std::string& filename, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<SubMesh>& subMeshes);
+
+} // namespace cmgl
\ No newline at end of file
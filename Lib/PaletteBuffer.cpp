@@ -0,0 +1,75 @@
+#include "PaletteBuffer.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Skeleton.hpp"
+
+namespace cmgl
+{
+
+PaletteBuffer::PaletteBuffer()
+	: mBinding(0)
+	, mAlignment(1)
+{
+}
+
+PaletteBuffer::~PaletteBuffer()
+{
+	destroy();
+}
+
+bool PaletteBuffer::create(unsigned int binding)
+{
+	destroy();
+
+	GLint maxBlockSize = 0;
+	glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+	if ((std::size_t)maxBlockSize < Skeleton::MaxBones * sizeof(glm::mat4))
+	{
+		fprintf(stderr, "Failed to create palette buffer, uniform blocks are limited to %d bytes\n", maxBlockSize);
+		return false;
+	}
+
+	// Palettes start on the binding offset alignment, counted in matrices
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	mAlignment = std::max<std::size_t>(1, ((std::size_t)alignment + sizeof(glm::mat4) - 1) / sizeof(glm::mat4));
+	mBinding = binding;
+	return mBuffer.create();
+}
+
+void PaletteBuffer::destroy()
+{
+	mBuffer.destroy();
+	mPalettes.clear();
+}
+
+void PaletteBuffer::clear()
+{
+	mPalettes.clear();
+}
+
+std::size_t PaletteBuffer::add(const glm::mat4* palette, std::size_t boneCount)
+{
+	const std::size_t offset = (mPalettes.size() + mAlignment - 1) / mAlignment * mAlignment;
+	boneCount = std::min(boneCount, Skeleton::MaxBones);
+	mPalettes.resize(offset);
+	mPalettes.insert(mPalettes.end(), palette, palette + boneCount);
+	return offset;
+}
+
+void PaletteBuffer::upload()
+{
+	// A whole block is bound from each palette's offset, the buffer goes that far past the last one
+	mBuffer.upload(mPalettes.data(), mPalettes.size() * sizeof(glm::mat4), (mPalettes.size() + Skeleton::MaxBones) * sizeof(glm::mat4));
+}
+
+void PaletteBuffer::bind(std::size_t palette) const
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, mBinding, mBuffer.getBuffer(), palette * sizeof(glm::mat4), Skeleton::MaxBones * sizeof(glm::mat4));
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "StreamBuffer.hpp"
+
+namespace cmgl
+{
+
+// Skinning matrices of every character drawn in a frame, gathered in a single uniform buffer
+// add() each pose during the frame, upload() once, then bind() a palette before drawing its mesh
+// Shaders read it as : layout (std140) uniform BonePalette { mat4 Bones[256]; };
+class PaletteBuffer
+{
+	public:
+		PaletteBuffer();
+		~PaletteBuffer();
+
+		PaletteBuffer(const PaletteBuffer&) = delete;
+		PaletteBuffer& operator=(const PaletteBuffer&) = delete;
+
+		// binding is the uniform buffer binding point the shaders' BonePalette block is assigned to
+		bool create(unsigned int binding);
+		void destroy();
+
+		// Forgets the palettes of the previous frame
+		void clear();
+
+		// Returns the handle given to bind(), palettes longer than Skeleton::MaxBones are cut
+		std::size_t add(const glm::mat4* palette, std::size_t boneCount);
+
+		// Sends every palette added since clear() through the upload ring
+		void upload();
+
+		void bind(std::size_t palette) const;
+
+	private:
+		StreamBuffer mBuffer;
+		unsigned int mBinding;
+		std::size_t mAlignment;
+		std::vector<glm::mat4> mPalettes;
+};
+
+} // namespace cmgl
\ No newline at end of file
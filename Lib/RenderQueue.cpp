@@ -0,0 +1,138 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const unsigned int queue_depth_bits = 16;
+	const unsigned int queue_mesh_bits = 16;
+	const unsigned int queue_texture_bits = 16;
+	const unsigned int queue_shader_bits = 12;
+	const unsigned int queue_pass_bits = 4;
+
+	const unsigned int queue_mesh_shift = queue_depth_bits;
+	const unsigned int queue_texture_shift = queue_mesh_shift + queue_mesh_bits;
+	const unsigned int queue_shader_shift = queue_texture_shift + queue_texture_bits;
+	const unsigned int queue_pass_shift = queue_shader_shift + queue_shader_bits;
+
+	std::uint64_t queue_field(unsigned int value, unsigned int bits, unsigned int shift)
+	{
+		return (std::uint64_t)(value & ((1u << bits) - 1)) << shift;
+	}
+
+	unsigned int queue_read_field(std::uint64_t key, unsigned int bits, unsigned int shift)
+	{
+		return (unsigned int)(key >> shift) & ((1u << bits) - 1);
+	}
+}
+
+std::uint64_t RenderQueue::makeKey(unsigned int pass, unsigned int shader, unsigned int texture, unsigned int mesh, float depth)
+{
+	const unsigned int maxDepth = (1u << priv::queue_depth_bits) - 1;
+	unsigned int depthBits = (unsigned int)(std::min(std::max(depth, 0.0f), 1.0f) * maxDepth);
+	if (pass == Transparent)
+	{
+		depthBits = maxDepth - depthBits;
+	}
+	return priv::queue_field(pass, priv::queue_pass_bits, priv::queue_pass_shift)
+		| priv::queue_field(shader, priv::queue_shader_bits, priv::queue_shader_shift)
+		| priv::queue_field(texture, priv::queue_texture_bits, priv::queue_texture_shift)
+		| priv::queue_field(mesh, priv::queue_mesh_bits, priv::queue_mesh_shift)
+		| depthBits;
+}
+
+unsigned int RenderQueue::getPass(std::uint64_t key)
+{
+	return priv::queue_read_field(key, priv::queue_pass_bits, priv::queue_pass_shift);
+}
+
+unsigned int RenderQueue::getShader(std::uint64_t key)
+{
+	return priv::queue_read_field(key, priv::queue_shader_bits, priv::queue_shader_shift);
+}
+
+unsigned int RenderQueue::getTexture(std::uint64_t key)
+{
+	return priv::queue_read_field(key, priv::queue_texture_bits, priv::queue_texture_shift);
+}
+
+unsigned int RenderQueue::getMesh(std::uint64_t key)
+{
+	return priv::queue_read_field(key, priv::queue_mesh_bits, priv::queue_mesh_shift);
+}
+
+void RenderQueue::clear()
+{
+	mEntries.clear();
+}
+
+void RenderQueue::push(std::uint64_t key, unsigned int payload)
+{
+	Entry entry;
+	entry.key = key;
+	entry.payload = payload;
+	mEntries.push_back(entry);
+}
+
+void RenderQueue::sort()
+{
+	const std::size_t count = mEntries.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	// One pass gathers the histograms of the eight bytes
+	std::size_t histograms[8][256] = {};
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const std::uint64_t key = mEntries[i].key;
+		for (unsigned int b = 0; b < 8; b++)
+		{
+			histograms[b][(key >> (b * 8)) & 0xFF]++;
+		}
+	}
+
+	mScratch.resize(count);
+	for (unsigned int b = 0; b < 8; b++)
+	{
+		std::size_t* histogram = histograms[b];
+		if (histogram[(mEntries[0].key >> (b * 8)) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		std::size_t offset = 0;
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			const std::size_t bucket = histogram[i];
+			histogram[i] = offset;
+			offset += bucket;
+		}
+		for (std::size_t i = 0; i < count; i++)
+		{
+			mScratch[histogram[(mEntries[i].key >> (b * 8)) & 0xFF]++] = mEntries[i];
+		}
+		mEntries.swap(mScratch);
+	}
+}
+
+std::size_t RenderQueue::getSize() const
+{
+	return mEntries.size();
+}
+
+std::uint64_t RenderQueue::getKey(std::size_t index) const
+{
+	return mEntries[index].key;
+}
+
+unsigned int RenderQueue::getPayload(std::size_t index) const
+{
+	return mEntries[index].payload;
+}
+
+} // namespace cmgl
\ No newline at end of file
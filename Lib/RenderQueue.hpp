@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cmgl
+{
+
+// Draw packets of a frame, sorted so that consecutive packets share as much state as possible
+// Keys from the most significant bits : pass (4) | shader (12) | texture (16) | mesh (16) | depth (16)
+// The payload is an index into the caller's own packet array
+class RenderQueue
+{
+	public:
+		enum Pass
+		{
+			Opaque = 0,
+			Transparent = 1
+		};
+
+		// Ids are cut to their field width, depth is the view distance in [0,1]
+		// Opaque packets are drawn front to back, transparent ones back to front
+		static std::uint64_t makeKey(unsigned int pass, unsigned int shader, unsigned int texture, unsigned int mesh, float depth);
+
+		static unsigned int getPass(std::uint64_t key);
+		static unsigned int getShader(std::uint64_t key);
+		static unsigned int getTexture(std::uint64_t key);
+		static unsigned int getMesh(std::uint64_t key);
+
+		void clear();
+		void push(std::uint64_t key, unsigned int payload);
+
+		// Stable LSD radix sort on bytes, bytes equal in every key are skipped
+		void sort();
+
+		std::size_t getSize() const;
+		std::uint64_t getKey(std::size_t index) const;
+		unsigned int getPayload(std::size_t index) const;
+
+	private:
+		struct Entry
+		{
+			std::uint64_t key;
+			unsigned int payload;
+		};
+
+		std::vector<Entry> mEntries;
+		std::vector<Entry> mScratch;
+};
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "Resource.hpp"
+
+namespace cmgl
+{
+
+Resource::Resource()
+	: mState(Empty)
+{
+}
+
+void Resource::setState(State state)
+{
+	mState = state;
+}
+
+Resource::State Resource::getState() const
+{
+	return mState;
+}
+
+bool Resource::isReady() const
+{
+	return mState == Ready;
+}
+
+bool Resource::isPending() const
+{
+	return mState == Pending;
+}
+
+} // namespace cmgl
\ No newline at end of file
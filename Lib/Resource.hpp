@@ -0,0 +1,32 @@
+#pragma once
+
+namespace cmgl
+{
+
+// Load state of a GPU asset, so that draws can skip or substitute what AsyncLoader has not uploaded yet
+// The state only changes on the GL thread
+class Resource
+{
+	public:
+		enum State
+		{
+			Empty,
+			Pending, // Queued on an AsyncLoader, not uploaded yet
+			Ready,
+			Failed
+		};
+
+	public:
+		Resource();
+
+		void setState(State state);
+		State getState() const;
+
+		bool isReady() const;
+		bool isPending() const;
+
+	private:
+		State mState;
+};
+
+} // namespace cmgl
\ No newline at end of file
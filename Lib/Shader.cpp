@@ -2,15 +2,26 @@
 
 #include <GL/glew.h>
 
+#include <atomic>
 #include <fstream>
 #include <sstream>
 
+#include "StateCache.hpp"
+
 namespace cmgl
 {
 
+namespace priv
+{
+	// 0 is kept for no shader
+	std::atomic<unsigned int> next_shader_sort_id(1);
+}
+
 Shader::Shader()
 	: mProgram(0)
+	, mSortId(priv::next_shader_sort_id++)
 	, mCurrentTexture(-1)
+	, mSamplersDirty(false)
 {
 }
 
@@ -19,6 +30,7 @@ Shader::~Shader()
 	if (isValid())
 	{
 		glDeleteProgram(mProgram);
+		StateCache::getDefault().forgetProgram(mProgram);
 	}
 }
 
@@ -54,12 +66,14 @@ bool Shader::loadFromFile(const std::string& vs, const std::string& fs)
 
 bool Shader::loadFromSource(const std::string& vs, const std::string& fs)
 {
-	if (glIsProgram(mProgram))
+	if (isValid())
 	{
 		glDeleteProgram(mProgram);
+		StateCache::getDefault().forgetProgram(mProgram);
 	}
 	mProgram = 0;
 	mCurrentTexture = -1;
+	mSamplersDirty = false;
 	mUniforms.clear();
 	mTextures.clear();
 
@@ -87,6 +101,9 @@ bool Shader::loadFromSource(const std::string& vs, const std::string& fs)
 	glLinkProgram(mProgram);
 	if (!isProgramLinked())
 	{
+		// A program that failed to link is not kept, so that isValid() stays a plain handle check
+		glDeleteProgram(mProgram);
+		mProgram = 0;
 		return false;
 	}
 
@@ -98,25 +115,44 @@ bool Shader::loadFromSource(const std::string& vs, const std::string& fs)
 
 void Shader::bind() const
 {
-	glUseProgram(mProgram);
-	auto itr = mTextures.begin();
-	for (std::size_t i = 1; i <= mTextures.size(); i++)
+	StateCache& cache = StateCache::getDefault();
+	cache.useProgram(mProgram);
+
+	// Sampler units are program state : only assigned again after the texture uniforms changed
+	if (mSamplersDirty)
 	{
-		glActiveTexture(GL_TEXTURE0 + i);
-		glUniform1i(itr->first, i);
-		itr->second->bind();
-		++itr;
+		GLint unit = 1;
+		for (auto itr = mTextures.begin(); itr != mTextures.end(); ++itr)
+		{
+			glUniform1i(itr->first, unit++);
+		}
+		if (mCurrentTexture != -1)
+		{
+			glUniform1i(mCurrentTexture, 0);
+		}
+		mSamplersDirty = false;
 	}
-	glActiveTexture(GL_TEXTURE0);
-	if (mCurrentTexture != -1)
+
+	unsigned int unit = 1;
+	for (auto itr = mTextures.begin(); itr != mTextures.end(); ++itr)
 	{
-		glUniform1i(mCurrentTexture, 0);
+		itr->second->bind(unit++);
 	}
+	cache.setActiveTexture(0);
 }
 
 bool Shader::isValid() const
 {
-	return glIsProgram(mProgram) == GL_TRUE;
+	return mProgram != 0;
+}
+
+void Shader::setUniform(const std::string& name, int x)
+{
+	GLint location = getUniformLocation(name);
+	if (location != -1)
+	{
+		glUniform1i(location, x);
+	}
 }
 
 void Shader::setUniform(const std::string& name, float x)
@@ -218,6 +254,7 @@ void Shader::setUniform(const std::string& name, const Texture& texture)
 		if (itr == mTextures.end())
 		{
 			mTextures[location] = &texture;
+			mSamplersDirty = true;
 		}
 		else
 		{
@@ -230,7 +267,80 @@ void Shader::setUniform(const std::string& name, SpecialUniforms type)
 {
 	switch (type)
 	{
-		case CurrentTexture: mCurrentTexture = getUniformLocation(name); break;
+		case CurrentTexture: mCurrentTexture = getUniformLocation(name); mSamplersDirty = true; break;
+	}
+}
+
+void Shader::setUniform(UniformHandle<int> uniform, int x)
+{
+	if (uniform.isValid())
+	{
+		glUniform1i(uniform.getLocation(), x);
+	}
+}
+
+void Shader::setUniform(UniformHandle<float> uniform, float x)
+{
+	if (uniform.isValid())
+	{
+		glUniform1f(uniform.getLocation(), x);
+	}
+}
+
+void Shader::setUniform(UniformHandle<glm::vec2> uniform, const glm::vec2& v)
+{
+	if (uniform.isValid())
+	{
+		glUniform2fv(uniform.getLocation(), 1, &v[0]);
+	}
+}
+
+void Shader::setUniform(UniformHandle<glm::vec3> uniform, const glm::vec3& v)
+{
+	if (uniform.isValid())
+	{
+		glUniform3fv(uniform.getLocation(), 1, &v[0]);
+	}
+}
+
+void Shader::setUniform(UniformHandle<glm::vec4> uniform, const glm::vec4& v)
+{
+	if (uniform.isValid())
+	{
+		glUniform4fv(uniform.getLocation(), 1, &v[0]);
+	}
+}
+
+void Shader::setUniform(UniformHandle<glm::mat3> uniform, const glm::mat3& m)
+{
+	if (uniform.isValid())
+	{
+		glUniformMatrix3fv(uniform.getLocation(), 1, GL_FALSE, &m[0][0]);
+	}
+}
+
+void Shader::setUniform(UniformHandle<glm::mat4> uniform, const glm::mat4& m)
+{
+	if (uniform.isValid())
+	{
+		glUniformMatrix4fv(uniform.getLocation(), 1, GL_FALSE, &m[0][0]);
+	}
+}
+
+void Shader::setUniform(UniformHandle<Color> uniform, const Color& color)
+{
+	if (uniform.isValid())
+	{
+		glUniform4f(uniform.getLocation(), (float)color.r / 255.0f, (float)color.g / 255.0f, (float)color.b / 255.0f, (float)color.a / 255.0f);
+	}
+}
+
+void Shader::setUniformBlock(const std::string& name, unsigned int binding)
+{
+	const GLuint index = glGetUniformBlockIndex(mProgram, name.c_str());
+	if (index != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(mProgram, index, binding);
 	}
 }
 
@@ -239,6 +349,11 @@ int Shader::getAttribLocation(const std::string& name) const
 	return glGetAttribLocation(mProgram, name.c_str());
 }
 
+unsigned int Shader::getSortId() const
+{
+	return mSortId;
+}
+
 int Shader::getUniformLocation(const std::string& name)
 {
 	auto it = mUniforms.find(name);
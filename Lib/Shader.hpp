@@ -8,6 +8,36 @@
 namespace cmgl
 {
 
+// Location of a uniform resolved once, setting it through the handle skips the name lookup
+// Only valid for the shader that gave it, until that shader is loaded again
+template <typename T>
+class UniformHandle
+{
+	public:
+		UniformHandle()
+			: mLocation(-1)
+		{
+		}
+
+		explicit UniformHandle(int location)
+			: mLocation(location)
+		{
+		}
+
+		int getLocation() const
+		{
+			return mLocation;
+		}
+
+		bool isValid() const
+		{
+			return mLocation != -1;
+		}
+
+	private:
+		int mLocation;
+};
+
 class Shader
 {
 	public:
@@ -27,6 +57,7 @@ class Shader
 		void bind() const;
 		bool isValid() const;
 
+		void setUniform(const std::string& name, int x);
 		void setUniform(const std::string& name, float x);
 		void setUniform(const std::string& name, float x, float y);
 		void setUniform(const std::string& name, float x, float y, float z);
@@ -40,8 +71,27 @@ class Shader
 		void setUniform(const std::string& name, const Texture& texture);
 		void setUniform(const std::string& name, SpecialUniforms type);
 
+		// Looks the name up once, for uniforms set on every draw
+		template <typename T>
+		UniformHandle<T> getUniformHandle(const std::string& name);
+
+		void setUniform(UniformHandle<int> uniform, int x);
+		void setUniform(UniformHandle<float> uniform, float x);
+		void setUniform(UniformHandle<glm::vec2> uniform, const glm::vec2& v);
+		void setUniform(UniformHandle<glm::vec3> uniform, const glm::vec3& v);
+		void setUniform(UniformHandle<glm::vec4> uniform, const glm::vec4& v);
+		void setUniform(UniformHandle<glm::mat3> uniform, const glm::mat3& m);
+		void setUniform(UniformHandle<glm::mat4> uniform, const glm::mat4& m);
+		void setUniform(UniformHandle<Color> uniform, const Color& color);
+
+		// Reads the uniform block from the buffer bound to this binding point
+		void setUniformBlock(const std::string& name, unsigned int binding);
+
 		int getAttribLocation(const std::string& name) const;
 
+		// Given once at construction and never reused, render queues sort draws by it
+		unsigned int getSortId() const;
+
 	private:
 		int getUniformLocation(const std::string& name);
 
@@ -51,9 +101,17 @@ class Shader
 
 	private:
 		unsigned int mProgram;
+		unsigned int mSortId;
 		int mCurrentTexture;
+		mutable bool mSamplersDirty;
 		std::map<std::string, int> mUniforms;
 		std::map<unsigned int, const Texture*> mTextures;
 };
 
+template <typename T>
+UniformHandle<T> Shader::getUniformHandle(const std::string& name)
+{
+	return UniformHandle<T>(getUniformLocation(name));
+}
+
 } // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "Skeleton.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtx/transform.hpp>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	// Index of the key that starts the segment holding time, and the blend factor towards the next key
+	template <typename Key>
+	std::size_t find_animation_key(const std::vector<Key>& keys, float time, float& blend)
+	{
+		const typename std::vector<Key>::const_iterator next = std::upper_bound(keys.begin(), keys.end(), time, [](float t, const Key& key)
+		{
+			return t < key.time;
+		});
+		blend = 0.0f;
+		if (next == keys.begin())
+		{
+			return 0;
+		}
+		if (next == keys.end())
+		{
+			return keys.size() - 1;
+		}
+		const std::size_t index = (std::size_t)(next - keys.begin()) - 1;
+		const float length = next->time - keys[index].time;
+		blend = (length > 0.0f) ? (time - keys[index].time) / length : 0.0f;
+		return index;
+	}
+
+	glm::vec3 sample_vector_keys(const std::vector<Animation::VectorKey>& keys, float time, const glm::vec3& fallback)
+	{
+		if (keys.empty())
+		{
+			return fallback;
+		}
+		float blend;
+		const std::size_t index = find_animation_key(keys, time, blend);
+		return (blend > 0.0f) ? glm::mix(keys[index].value, keys[index + 1].value, blend) : keys[index].value;
+	}
+
+	glm::quat sample_rotation_keys(const std::vector<Animation::RotationKey>& keys, float time)
+	{
+		if (keys.empty())
+		{
+			return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		}
+		float blend;
+		const std::size_t index = find_animation_key(keys, time, blend);
+		return (blend > 0.0f) ? glm::normalize(glm::slerp(keys[index].value, keys[index + 1].value, blend)) : keys[index].value;
+	}
+}
+
+Skeleton::Skeleton()
+{
+}
+
+std::size_t Skeleton::addBone(const std::string& name, int parent, const glm::mat4& bindTransform, const glm::mat4& inverseBind)
+{
+	Bone bone;
+	bone.name = name;
+	bone.parent = parent;
+	bone.bindTransform = bindTransform;
+	bone.inverseBind = inverseBind;
+	mBones.push_back(bone);
+	return mBones.size() - 1;
+}
+
+void Skeleton::setInverseBind(std::size_t index, const glm::mat4& inverseBind)
+{
+	mBones[index].inverseBind = inverseBind;
+}
+
+void Skeleton::clear()
+{
+	mBones.clear();
+}
+
+int Skeleton::findBone(const std::string& name) const
+{
+	for (std::size_t i = 0; i < mBones.size(); i++)
+	{
+		if (mBones[i].name == name)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+std::size_t Skeleton::getBoneCount() const
+{
+	return mBones.size();
+}
+
+const Skeleton::Bone& Skeleton::getBone(std::size_t index) const
+{
+	return mBones[index];
+}
+
+Pose::Pose()
+{
+}
+
+void Pose::reset(const Skeleton& skeleton)
+{
+	const std::size_t count = skeleton.getBoneCount();
+	mLocals.resize(count);
+	mGlobals.resize(count);
+	mPalette.resize(count);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		mLocals[i] = skeleton.getBone(i).bindTransform;
+	}
+	computePalette(skeleton);
+}
+
+void Pose::setLocalTransform(std::size_t bone, const glm::mat4& transform)
+{
+	mLocals[bone] = transform;
+}
+
+const glm::mat4& Pose::getLocalTransform(std::size_t bone) const
+{
+	return mLocals[bone];
+}
+
+void Pose::computePalette(const Skeleton& skeleton)
+{
+	// Parents come first, their global transform is always ready when a child needs it
+	for (std::size_t i = 0; i < mLocals.size(); i++)
+	{
+		const Skeleton::Bone& bone = skeleton.getBone(i);
+		mGlobals[i] = (bone.parent >= 0) ? mGlobals[bone.parent] * mLocals[i] : mLocals[i];
+		mPalette[i] = mGlobals[i] * bone.inverseBind;
+	}
+}
+
+const glm::mat4* Pose::getPalette() const
+{
+	return mPalette.data();
+}
+
+std::size_t Pose::getBoneCount() const
+{
+	return mPalette.size();
+}
+
+Animation::Animation()
+	: mDuration(0.0f)
+{
+}
+
+void Animation::setName(const std::string& name)
+{
+	mName = name;
+}
+
+const std::string& Animation::getName() const
+{
+	return mName;
+}
+
+void Animation::setDuration(float duration)
+{
+	mDuration = duration;
+}
+
+float Animation::getDuration() const
+{
+	return mDuration;
+}
+
+void Animation::addChannel(const Channel& channel)
+{
+	mChannels.push_back(channel);
+}
+
+std::size_t Animation::getChannelCount() const
+{
+	return mChannels.size();
+}
+
+void Animation::sample(float time, Pose& pose) const
+{
+	if (mDuration > 0.0f)
+	{
+		time = std::fmod(time, mDuration);
+		if (time < 0.0f)
+		{
+			time += mDuration;
+		}
+	}
+
+	for (std::size_t i = 0; i < mChannels.size(); i++)
+	{
+		const Channel& channel = mChannels[i];
+		if (channel.bone >= pose.getBoneCount())
+		{
+			continue;
+		}
+		const glm::vec3 position = priv::sample_vector_keys(channel.positions, time, glm::vec3(0.0f));
+		const glm::quat rotation = priv::sample_rotation_keys(channel.rotations, time);
+		const glm::vec3 scale = priv::sample_vector_keys(channel.scales, time, glm::vec3(1.0f));
+		pose.setLocalTransform(channel.bone, glm::translate(position) * glm::mat4_cast(rotation) * glm::scale(scale));
+	}
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace cmgl
+{
+
+// Bone hierarchy of a skinned mesh, parents are always stored before their children
+class Skeleton
+{
+	public:
+		// SkinnedVertex addresses bones with 8 bits
+		static const std::size_t MaxBones = 256;
+
+		struct Bone
+		{
+			std::string name;
+			int parent; // -1 for a root
+			glm::mat4 bindTransform; // rest transform, relative to the parent
+			glm::mat4 inverseBind; // from mesh space to the rest space of the bone
+		};
+
+	public:
+		Skeleton();
+
+		// The parent must already be in the skeleton, returns the index of the new bone
+		std::size_t addBone(const std::string& name, int parent, const glm::mat4& bindTransform, const glm::mat4& inverseBind = glm::mat4(1.0f));
+		void setInverseBind(std::size_t index, const glm::mat4& inverseBind);
+		void clear();
+
+		int findBone(const std::string& name) const;
+		std::size_t getBoneCount() const;
+		const Bone& getBone(std::size_t index) const;
+
+	private:
+		std::vector<Bone> mBones;
+};
+
+// Local transform of every bone of a skeleton, and the skinning matrices that follow from them
+class Pose
+{
+	public:
+		Pose();
+
+		// Every bone back to its rest transform
+		void reset(const Skeleton& skeleton);
+
+		void setLocalTransform(std::size_t bone, const glm::mat4& transform);
+		const glm::mat4& getLocalTransform(std::size_t bone) const;
+
+		// Palette matrix i moves a mesh space vertex bound to bone i along with the bone, from rest to this pose
+		void computePalette(const Skeleton& skeleton);
+		const glm::mat4* getPalette() const;
+		std::size_t getBoneCount() const;
+
+	private:
+		std::vector<glm::mat4> mLocals;
+		std::vector<glm::mat4> mGlobals;
+		std::vector<glm::mat4> mPalette;
+};
+
+// Keyframed bone tracks in seconds, sampled into a pose
+class Animation
+{
+	public:
+		struct VectorKey
+		{
+			float time;
+			glm::vec3 value;
+		};
+
+		struct RotationKey
+		{
+			float time;
+			glm::quat value;
+		};
+
+		struct Channel
+		{
+			std::size_t bone;
+			std::vector<VectorKey> positions;
+			std::vector<RotationKey> rotations;
+			std::vector<VectorKey> scales;
+		};
+
+	public:
+		Animation();
+
+		void setName(const std::string& name);
+		const std::string& getName() const;
+
+		void setDuration(float duration);
+		float getDuration() const;
+
+		void addChannel(const Channel& channel);
+		std::size_t getChannelCount() const;
+
+		// Loops over the duration, bones without a channel keep their local transform
+		void sample(float time, Pose& pose) const;
+
+	private:
+		std::string mName;
+		float mDuration;
+		std::vector<Channel> mChannels;
+};
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "SkinnedMesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <assimp/mesh.h>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	struct VertexInfluences
+	{
+		unsigned int bones[4];
+		float weights[4];
+	};
+
+	glm::mat4 to_glm_matrix(const aiMatrix4x4& matrix)
+	{
+		// Assimp matrices are row major
+		glm::mat4 result;
+		std::memcpy(&result, &matrix, sizeof(result));
+		return glm::transpose(result);
+	}
+
+	void collect_scene_nodes(const aiNode* node, std::unordered_map<std::string, const aiNode*>& nodes, std::vector<const aiNode*>& meshNodes)
+	{
+		nodes.insert(std::make_pair(std::string(node->mName.C_Str()), node));
+		for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		{
+			if (meshNodes[node->mMeshes[i]] == nullptr)
+			{
+				meshNodes[node->mMeshes[i]] = node;
+			}
+		}
+		for (unsigned int i = 0; i < node->mNumChildren; i++)
+		{
+			collect_scene_nodes(node->mChildren[i], nodes, meshNodes);
+		}
+	}
+
+	// A node that vertices follow becomes a bone, and so do its ancestors below the scene root
+	void require_skeleton_node(const aiNode* node, const aiNode* root, std::unordered_set<const aiNode*>& required)
+	{
+		while (node != nullptr && node != root && required.insert(node).second)
+		{
+			node = node->mParent;
+		}
+	}
+
+	// Depth first, so that parents are added before their children
+	void add_skeleton_bones(const aiNode* node, int parent, const std::unordered_set<const aiNode*>& required, std::unordered_map<const aiNode*, int>& bones, Skeleton& skeleton)
+	{
+		for (unsigned int i = 0; i < node->mNumChildren; i++)
+		{
+			const aiNode* child = node->mChildren[i];
+			if (required.count(child) > 0)
+			{
+				const int index = (int)skeleton.addBone(child->mName.C_Str(), parent, to_glm_matrix(child->mTransformation));
+				bones[child] = index;
+				add_skeleton_bones(child, index, required, bones, skeleton);
+			}
+		}
+	}
+
+	// Keeps the four largest influences
+	void add_influence(VertexInfluences& influences, unsigned int bone, float weight)
+	{
+		unsigned int smallest = 0;
+		for (unsigned int k = 1; k < 4; k++)
+		{
+			if (influences.weights[k] < influences.weights[smallest])
+			{
+				smallest = k;
+			}
+		}
+		if (weight > influences.weights[smallest])
+		{
+			influences.bones[smallest] = bone;
+			influences.weights[smallest] = weight;
+		}
+	}
+
+	// Largest first, quantized to unorm8 so that the weights still sum to exactly one
+	void set_vertex_weights(VertexInfluences influences, unsigned int fallbackBone, SkinnedVertex& vertex)
+	{
+		const float sum = influences.weights[0] + influences.weights[1] + influences.weights[2] + influences.weights[3];
+		if (sum <= 0.0f)
+		{
+			vertex.bones[0] = (unsigned char)fallbackBone;
+			return;
+		}
+
+		unsigned int order[4] = { 0, 1, 2, 3 };
+		std::sort(order, order + 4, [&](unsigned int a, unsigned int b)
+		{
+			return influences.weights[a] > influences.weights[b];
+		});
+		int total = 0;
+		for (unsigned int k = 0; k < 4; k++)
+		{
+			const unsigned int weight = (unsigned int)std::floor(influences.weights[order[k]] / sum * 255.0f + 0.5f);
+			vertex.bones[k] = (weight > 0) ? (unsigned char)influences.bones[order[k]] : 0;
+			vertex.weights[k] = (unsigned char)weight;
+			total += (int)weight;
+		}
+		vertex.weights[0] = (unsigned char)((int)vertex.weights[0] + 255 - total);
+	}
+
+	void import_animation(const aiAnimation* source, const std::unordered_map<std::string, const aiNode*>& nodes, const std::unordered_map<const aiNode*, int>& bones, Animation& animation)
+	{
+		// Assimp counts in ticks, the animation in seconds
+		const double ticksPerSecond = (source->mTicksPerSecond > 0.0) ? source->mTicksPerSecond : 25.0;
+		animation.setName(source->mName.C_Str());
+		animation.setDuration((float)(source->mDuration / ticksPerSecond));
+
+		for (unsigned int c = 0; c < source->mNumChannels; c++)
+		{
+			const aiNodeAnim* track = source->mChannels[c];
+			const std::unordered_map<std::string, const aiNode*>::const_iterator node = nodes.find(track->mNodeName.C_Str());
+			if (node == nodes.end() || bones.count(node->second) == 0)
+			{
+				continue;
+			}
+
+			Animation::Channel channel;
+			channel.bone = (std::size_t)bones.at(node->second);
+			channel.positions.resize(track->mNumPositionKeys);
+			for (unsigned int k = 0; k < track->mNumPositionKeys; k++)
+			{
+				const aiVectorKey& key = track->mPositionKeys[k];
+				channel.positions[k].time = (float)(key.mTime / ticksPerSecond);
+				channel.positions[k].value = glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z);
+			}
+			channel.rotations.resize(track->mNumRotationKeys);
+			for (unsigned int k = 0; k < track->mNumRotationKeys; k++)
+			{
+				const aiQuatKey& key = track->mRotationKeys[k];
+				channel.rotations[k].time = (float)(key.mTime / ticksPerSecond);
+				channel.rotations[k].value = glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z);
+			}
+			channel.scales.resize(track->mNumScalingKeys);
+			for (unsigned int k = 0; k < track->mNumScalingKeys; k++)
+			{
+				const aiVectorKey& key = track->mScalingKeys[k];
+				channel.scales[k].time = (float)(key.mTime / ticksPerSecond);
+				channel.scales[k].value = glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z);
+			}
+			animation.addChannel(channel);
+		}
+	}
+}
+
+SkinnedMesh::SkinnedMesh()
+{
+}
+
+bool SkinnedMesh::loadFromFile(const std::string& filename)
+{
+	mSkeleton.clear();
+	mAnimations.clear();
+	mVertices.clear();
+
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(filename, (aiProcessPreset_TargetRealtime_Fast & ~aiProcess_CalcTangentSpace) | aiProcess_LimitBoneWeights);
+	if (!scene || !scene->mRootNode)
+	{
+		printf("Error : %s\n", importer.GetErrorString());
+		mMesh.setState(Resource::Failed);
+		return false;
+	}
+
+	std::unordered_map<std::string, const aiNode*> nodes;
+	std::vector<const aiNode*> meshNodes(scene->mNumMeshes, nullptr);
+	priv::collect_scene_nodes(scene->mRootNode, nodes, meshNodes);
+
+	std::unordered_set<const aiNode*> required;
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+	{
+		const aiMesh* mesh = scene->mMeshes[m];
+		for (unsigned int b = 0; b < mesh->mNumBones; b++)
+		{
+			const std::unordered_map<std::string, const aiNode*>::const_iterator node = nodes.find(mesh->mBones[b]->mName.C_Str());
+			if (node != nodes.end())
+			{
+				priv::require_skeleton_node(node->second, scene->mRootNode, required);
+			}
+		}
+		if (mesh->mNumBones == 0)
+		{
+			priv::require_skeleton_node(meshNodes[m], scene->mRootNode, required);
+		}
+	}
+
+	// Parts hanging from the scene root directly get a bone of their own, with the identity as rest transform
+	std::unordered_map<const aiNode*, int> bones;
+	priv::add_skeleton_bones(scene->mRootNode, -1, required, bones, mSkeleton);
+	if (mSkeleton.getBoneCount() == 0 || std::find(meshNodes.begin(), meshNodes.end(), scene->mRootNode) != meshNodes.end())
+	{
+		bones[scene->mRootNode] = (int)mSkeleton.addBone(scene->mRootNode->mName.C_Str(), -1, glm::mat4(1.0f));
+	}
+	if (mSkeleton.getBoneCount() > Skeleton::MaxBones)
+	{
+		fprintf(stderr, "Failed to load skinned mesh %s, %u bones for at most %u\n", filename.c_str(), (unsigned int)mSkeleton.getBoneCount(), (unsigned int)Skeleton::MaxBones);
+		mSkeleton.clear();
+		mMesh.setState(Resource::Failed);
+		return false;
+	}
+
+	std::vector<unsigned int> indices;
+	std::vector<Mesh::SubMesh> subMeshes;
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+	{
+		const aiMesh* mesh = scene->mMeshes[m];
+		if ((mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) == 0 || meshNodes[m] == nullptr)
+		{
+			continue;
+		}
+
+		Mesh::SubMesh subMesh;
+		subMesh.indexOffset = (unsigned int)indices.size();
+		subMesh.baseVertex = (unsigned int)mVertices.size();
+		subMesh.materialIndex = mesh->mMaterialIndex;
+
+		// Offset matrices take the mesh to the rest space of each bone
+		priv::VertexInfluences empty;
+		std::memset(&empty, 0, sizeof(empty));
+		std::vector<priv::VertexInfluences> influences(mesh->mNumVertices, empty);
+		for (unsigned int b = 0; b < mesh->mNumBones; b++)
+		{
+			const aiBone* bone = mesh->mBones[b];
+			const std::unordered_map<std::string, const aiNode*>::const_iterator node = nodes.find(bone->mName.C_Str());
+			if (node == nodes.end() || bones.count(node->second) == 0)
+			{
+				continue;
+			}
+			const unsigned int index = (unsigned int)bones[node->second];
+			mSkeleton.setInverseBind(index, priv::to_glm_matrix(bone->mOffsetMatrix));
+			for (unsigned int w = 0; w < bone->mNumWeights; w++)
+			{
+				if (bone->mWeights[w].mVertexId < mesh->mNumVertices)
+				{
+					priv::add_influence(influences[bone->mWeights[w].mVertexId], index, bone->mWeights[w].mWeight);
+				}
+			}
+		}
+
+		// Vertices without weights follow the node of their part
+		const std::unordered_map<const aiNode*, int>::const_iterator meshBone = bones.find(meshNodes[m]);
+		const unsigned int fallbackBone = (meshBone != bones.end()) ? (unsigned int)meshBone->second : 0;
+		const bool hasUV = mesh->HasTextureCoords(0);
+		const bool hasNormals = mesh->HasNormals();
+		mVertices.reserve(mVertices.size() + mesh->mNumVertices);
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+		{
+			SkinnedVertex vertex;
+			memcpy(&vertex.position, &mesh->mVertices[i], 3 * sizeof(float));
+			if (hasUV)
+			{
+				memcpy(&vertex.uv, &mesh->mTextureCoords[0][i], 2 * sizeof(float));
+			}
+			if (hasNormals)
+			{
+				memcpy(&vertex.normal, &mesh->mNormals[i], 3 * sizeof(float));
+			}
+			priv::set_vertex_weights(influences[i], fallbackBone, vertex);
+			mVertices.push_back(vertex);
+		}
+
+		indices.reserve(indices.size() + 3 * mesh->mNumFaces);
+		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+		{
+			if (mesh->mFaces[i].mNumIndices == 3)
+			{
+				indices.push_back(mesh->mFaces[i].mIndices[0]);
+				indices.push_back(mesh->mFaces[i].mIndices[1]);
+				indices.push_back(mesh->mFaces[i].mIndices[2]);
+			}
+		}
+
+		subMesh.indexCount = (unsigned int)indices.size() - subMesh.indexOffset;
+		subMeshes.push_back(subMesh);
+	}
+
+	mAnimations.resize(scene->mNumAnimations);
+	for (unsigned int a = 0; a < scene->mNumAnimations; a++)
+	{
+		priv::import_animation(scene->mAnimations[a], nodes, bones, mAnimations[a]);
+	}
+
+	return mMesh.loadFromMemory(mVertices.data(), mVertices.size(), indices.data(), indices.size(), subMeshes.data(), subMeshes.size());
+}
+
+Mesh& SkinnedMesh::getMesh()
+{
+	return mMesh;
+}
+
+const Skeleton& SkinnedMesh::getSkeleton() const
+{
+	return mSkeleton;
+}
+
+std::size_t SkinnedMesh::getAnimationCount() const
+{
+	return mAnimations.size();
+}
+
+const Animation& SkinnedMesh::getAnimation(std::size_t index) const
+{
+	return mAnimations[index];
+}
+
+int SkinnedMesh::findAnimation(const std::string& name) const
+{
+	for (std::size_t i = 0; i < mAnimations.size(); i++)
+	{
+		if (mAnimations[i].getName() == name)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+const std::vector<SkinnedVertex>& SkinnedMesh::getVertices() const
+{
+	return mVertices;
+}
+
+} // namespace cmgl
\ No newline at end of file
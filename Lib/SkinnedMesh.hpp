@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Mesh.hpp"
+#include "Skeleton.hpp"
+#include "Vertex.hpp"
+
+namespace cmgl
+{
+
+// Mesh following the bones of a skeleton, imported with its animations through Assimp
+// The rest pose vertices stay on the CPU for skinVertices, the GPU copy is drawn with a PaletteBuffer bound
+// Parts without bones follow the node they hang from, the scene root itself is not a bone
+class SkinnedMesh
+{
+	public:
+		SkinnedMesh();
+
+		bool loadFromFile(const std::string& filename);
+
+		Mesh& getMesh();
+		const Skeleton& getSkeleton() const;
+
+		std::size_t getAnimationCount() const;
+		const Animation& getAnimation(std::size_t index) const;
+		int findAnimation(const std::string& name) const;
+
+		const std::vector<SkinnedVertex>& getVertices() const;
+
+	private:
+		Mesh mMesh;
+		Skeleton mSkeleton;
+		std::vector<Animation> mAnimations;
+		std::vector<SkinnedVertex> mVertices;
+};
+
+} // namespace cmgl
\ No newline at end of file
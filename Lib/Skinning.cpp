@@ -0,0 +1,111 @@
+#include "Skinning.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CMGL_SKINNING_SSE
+#endif
+
+namespace cmgl
+{
+
+namespace priv
+{
+	// Below this many vertices per thread, starting the threads costs more than it saves
+	const std::size_t skin_min_vertices_per_thread = 8192;
+
+	const float skin_weight_scale = 1.0f / 255.0f;
+
+	glm::vec3 normalize_skinned_normal(float x, float y, float z)
+	{
+		const float length = std::sqrt(x * x + y * y + z * z);
+		return (length > 0.0f) ? glm::vec3(x / length, y / length, z / length) : glm::vec3(0.0f, 1.0f, 0.0f);
+	}
+
+#if defined(CMGL_SKINNING_SSE)
+	// The four columns of the blended matrix are built in registers, unused influences are skipped
+	void skin_vertex_range(const SkinnedVertex* vertices, const glm::mat4* palette, Vertex* output, std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			const SkinnedVertex& vertex = vertices[i];
+			const float* matrix = &palette[vertex.bones[0]][0][0];
+			__m128 weight = _mm_set1_ps(vertex.weights[0] * skin_weight_scale);
+			__m128 c0 = _mm_mul_ps(_mm_loadu_ps(matrix), weight);
+			__m128 c1 = _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight);
+			__m128 c2 = _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight);
+			__m128 c3 = _mm_mul_ps(_mm_loadu_ps(matrix + 12), weight);
+			for (unsigned int k = 1; k < 4; k++)
+			{
+				if (vertex.weights[k] == 0)
+				{
+					continue;
+				}
+				matrix = &palette[vertex.bones[k]][0][0];
+				weight = _mm_set1_ps(vertex.weights[k] * skin_weight_scale);
+				c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(matrix), weight));
+				c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight));
+				c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight));
+				c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(matrix + 12), weight));
+			}
+
+			const __m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(vertex.position.x)), _mm_mul_ps(c1, _mm_set1_ps(vertex.position.y))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(vertex.position.z)), c3));
+			const __m128 normal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(vertex.normal.x)), _mm_mul_ps(c1, _mm_set1_ps(vertex.normal.y))),
+				_mm_mul_ps(c2, _mm_set1_ps(vertex.normal.z)));
+			float p[4];
+			float n[4];
+			_mm_storeu_ps(p, position);
+			_mm_storeu_ps(n, normal);
+
+			output[i].position = glm::vec3(p[0], p[1], p[2]);
+			output[i].uv = vertex.uv;
+			output[i].normal = normalize_skinned_normal(n[0], n[1], n[2]);
+		}
+	}
+#else
+	void skin_vertex_range(const SkinnedVertex* vertices, const glm::mat4* palette, Vertex* output, std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			const SkinnedVertex& vertex = vertices[i];
+			glm::mat4 skin = palette[vertex.bones[0]] * (vertex.weights[0] * skin_weight_scale);
+			for (unsigned int k = 1; k < 4; k++)
+			{
+				if (vertex.weights[k] != 0)
+				{
+					skin = skin + palette[vertex.bones[k]] * (vertex.weights[k] * skin_weight_scale);
+				}
+			}
+
+			const glm::vec4 position = skin * glm::vec4(vertex.position, 1.0f);
+			const glm::vec4 normal = skin * glm::vec4(vertex.normal, 0.0f);
+			output[i].position = glm::vec3(position);
+			output[i].uv = vertex.uv;
+			output[i].normal = normalize_skinned_normal(normal.x, normal.y, normal.z);
+		}
+	}
+#endif
+}
+
+void skinVertices(const SkinnedVertex* vertices, std::size_t vertexCount, const glm::mat4* palette, Vertex* output)
+{
+	// Vertices are independent, each thread takes a contiguous range
+	const std::size_t threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), vertexCount / priv::skin_min_vertices_per_thread + 1);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < threadCount; i++)
+	{
+		threads.push_back(std::thread(priv::skin_vertex_range, vertices, palette, output, vertexCount * i / threadCount, vertexCount * (i + 1) / threadCount));
+	}
+	priv::skin_vertex_range(vertices, palette, output, 0, vertexCount / threadCount);
+	for (std::size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
+
+} // namespace cmgl
\ No newline at end of file
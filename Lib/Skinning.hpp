@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "Vertex.hpp"
+
+namespace cmgl
+{
+
+// Linear blend skinning on the CPU, for headless tools and software rendering
+// Every vertex is moved by the weighted sum of its bones' palette matrices, normals are renormalized
+// Uses SSE where available, large meshes are split over every hardware thread
+void skinVertices(const SkinnedVertex* vertices, std::size_t vertexCount, const glm::mat4* palette, Vertex* output);
+
+} // namespace cmgl
\ No newline at end of file
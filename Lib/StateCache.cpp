@@ -0,0 +1,133 @@
+#include "StateCache.hpp"
+
+#include <GL/glew.h>
+
+namespace cmgl
+{
+
+StateCache::StateCache()
+{
+	invalidate();
+	resetStatistics();
+}
+
+void StateCache::useProgram(unsigned int program)
+{
+	if (change(mProgram, program))
+	{
+		glUseProgram(program);
+	}
+}
+
+void StateCache::bindVertexArray(unsigned int vertexArray)
+{
+	if (change(mVertexArray, vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+	}
+}
+
+void StateCache::setActiveTexture(unsigned int unit)
+{
+	if (change(mActiveTexture, unit))
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+}
+
+void StateCache::bindTexture(unsigned int texture)
+{
+	// Without a known active unit, nothing can be said about its binding
+	if (mActiveTexture >= MaxTextureUnits)
+	{
+		mStatistics.issuedCalls++;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+	if (change(mTextures[mActiveTexture], texture))
+	{
+		glBindTexture(GL_TEXTURE_2D, texture);
+	}
+}
+
+void StateCache::bindTexture(unsigned int unit, unsigned int texture)
+{
+	if (unit < MaxTextureUnits && mTextures[unit] == texture)
+	{
+		mStatistics.skippedCalls++;
+		return;
+	}
+	setActiveTexture(unit);
+	bindTexture(texture);
+}
+
+void StateCache::forgetProgram(unsigned int program)
+{
+	if (mProgram == program)
+	{
+		mProgram = Unknown;
+	}
+}
+
+void StateCache::forgetVertexArray(unsigned int vertexArray)
+{
+	// Deleting the bound vertex array reverts the binding to 0
+	if (mVertexArray == vertexArray)
+	{
+		mVertexArray = 0;
+	}
+}
+
+void StateCache::forgetTexture(unsigned int texture)
+{
+	// Deleting a texture unbinds it from every unit
+	for (unsigned int i = 0; i < MaxTextureUnits; i++)
+	{
+		if (mTextures[i] == texture)
+		{
+			mTextures[i] = 0;
+		}
+	}
+}
+
+void StateCache::invalidate()
+{
+	mProgram = Unknown;
+	mVertexArray = Unknown;
+	mActiveTexture = Unknown;
+	for (unsigned int i = 0; i < MaxTextureUnits; i++)
+	{
+		mTextures[i] = Unknown;
+	}
+}
+
+const StateCache::Statistics& StateCache::getStatistics() const
+{
+	return mStatistics;
+}
+
+void StateCache::resetStatistics()
+{
+	mStatistics.issuedCalls = 0;
+	mStatistics.skippedCalls = 0;
+}
+
+StateCache& StateCache::getDefault()
+{
+	static StateCache cache;
+	return cache;
+}
+
+bool StateCache::change(unsigned int& current, unsigned int value)
+{
+	if (current == value)
+	{
+		mStatistics.skippedCalls++;
+		return false;
+	}
+	current = value;
+	mStatistics.issuedCalls++;
+	return true;
+}
+
+} // namespace cmgl
\ No newline at end of file
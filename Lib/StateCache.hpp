@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cmgl
+{
+
+// Shadow copy of the GL bindings of the context, binds matching the current state are skipped
+// Tracks the program, the vertex array, the active texture unit and the 2D texture of each unit
+// Every bind of these goes through the cache, deleted objects must be forgotten so that a reused name is bound again
+class StateCache
+{
+	public:
+		enum
+		{
+			MaxTextureUnits = 32
+		};
+
+		struct Statistics
+		{
+			std::size_t issuedCalls;
+			std::size_t skippedCalls;
+		};
+
+	public:
+		StateCache();
+
+		void useProgram(unsigned int program);
+		void bindVertexArray(unsigned int vertexArray);
+		void setActiveTexture(unsigned int unit);
+
+		// On the active unit
+		void bindTexture(unsigned int texture);
+		void bindTexture(unsigned int unit, unsigned int texture);
+
+		// Call right after deleting the object
+		void forgetProgram(unsigned int program);
+		void forgetVertexArray(unsigned int vertexArray);
+		void forgetTexture(unsigned int texture);
+
+		// After GL calls made behind the cache's back, the next binds are all issued
+		void invalidate();
+
+		const Statistics& getStatistics() const;
+		void resetStatistics();
+
+		static StateCache& getDefault();
+
+	private:
+		// Values no GL name takes, so that the first bind after invalidate() is issued
+		enum
+		{
+			Unknown = ~0u
+		};
+
+		bool change(unsigned int& current, unsigned int value);
+
+	private:
+		unsigned int mProgram;
+		unsigned int mVertexArray;
+		unsigned int mActiveTexture;
+		unsigned int mTextures[MaxTextureUnits];
+		Statistics mStatistics;
+};
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "StreamBuffer.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+
+#include "UploadRing.hpp"
+
+namespace cmgl
+{
+
+StreamBuffer::StreamBuffer()
+	: mBuffer(0)
+	, mCapacity(0)
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	destroy();
+}
+
+bool StreamBuffer::create()
+{
+	destroy();
+	glGenBuffers(1, &mBuffer);
+	return true;
+}
+
+void StreamBuffer::destroy()
+{
+	if (mBuffer != 0)
+	{
+		glDeleteBuffers(1, &mBuffer);
+	}
+	mBuffer = 0;
+	mCapacity = 0;
+}
+
+void StreamBuffer::upload(const void* data, std::size_t size, std::size_t capacity)
+{
+	if (mBuffer == 0 || size == 0)
+	{
+		return;
+	}
+
+	capacity = std::max(size, capacity);
+	if (capacity > mCapacity)
+	{
+		mCapacity = std::max(capacity, mCapacity * 2);
+	}
+
+	// Orphaned every frame, the draws of the previous frame keep reading their own copy
+	// The copy binding point leaves the vertex and uniform bindings of the caller alone
+	glBindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, mCapacity, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	UploadRing::getDefault().copyToBuffer(mBuffer, 0, data, size);
+}
+
+unsigned int StreamBuffer::getBuffer() const
+{
+	return mBuffer;
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cmgl
+{
+
+// GPU buffer whose whole content is replaced every frame, the storage behind UniformBuffer, InstanceBuffer and PaletteBuffer
+// Each upload orphans the storage and copies through the upload ring, the capacity grows to the largest upload
+class StreamBuffer
+{
+	public:
+		StreamBuffer();
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		bool create();
+		void destroy();
+
+		// The storage holds at least capacity bytes, for readers binding whole ranges past the end of the data
+		void upload(const void* data, std::size_t size, std::size_t capacity = 0);
+
+		unsigned int getBuffer() const;
+
+	private:
+		unsigned int mBuffer;
+		std::size_t mCapacity;
+};
+
+} // namespace cmgl
\ No newline at end of file
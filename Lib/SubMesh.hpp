@@ -0,0 +1,15 @@
+#pragma once
+
+namespace cmgl
+{
+
+// Draw range of a mesh : indexCount indices from indexOffset, added to baseVertex, drawn with one material
+struct SubMesh
+{
+	unsigned int indexOffset;
+	unsigned int indexCount;
+	unsigned int baseVertex;
+	unsigned int materialIndex;
+};
+
+} // namespace cmgl
\ No newline at end of file
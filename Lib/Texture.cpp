@@ -2,11 +2,23 @@
 
 #include <GL/glew.h>
 
+#include <atomic>
+
+#include "StateCache.hpp"
+#include "UploadRing.hpp"
+
 namespace cmgl
 {
 
+namespace priv
+{
+	// 0 is kept for no texture
+	std::atomic<unsigned int> next_texture_sort_id(1);
+}
+
 Texture::Texture()
 	: mTexture(0)
+	, mSortId(priv::next_texture_sort_id++)
 	, mSize({ 0,0 })
 	, mActualSize({ 0,0 })
 	, mIsSmooth(false)
@@ -19,13 +31,19 @@ Texture::~Texture()
 	if (isValid())
 	{
 		glDeleteTextures(1, &mTexture);
+		StateCache::getDefault().forgetTexture(mTexture);
 	}
 }
 
 bool Texture::loadFromFile(const std::string& filename)
 {
 	Image image;
-	return image.loadFromFile(filename) && loadFromImage(image);
+	if (!image.loadFromFile(filename))
+	{
+		setState(Failed);
+		return false;
+	}
+	return loadFromImage(image);
 }
 
 bool Texture::loadFromImage(const Image& image)
@@ -35,6 +53,7 @@ bool Texture::loadFromImage(const Image& image)
 		update(image);
 		return true;
 	}
+	setState(Failed);
 	return false;
 }
 
@@ -60,13 +79,14 @@ bool Texture::create(unsigned int width, unsigned int height)
 		glGenTextures(1, &mTexture);
 	}
 
-	glBindTexture(GL_TEXTURE_2D, mTexture);
+	StateCache::getDefault().bindTexture(mTexture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mActualSize.x, mActualSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mIsSmooth ? GL_LINEAR : GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mIsSmooth ? GL_LINEAR : GL_NEAREST);
 	mHasMipmap = false;
+	setState(Ready);
 	return true;
 }
 
@@ -89,8 +109,8 @@ void Texture::update(const unsigned char* pixels, unsigned int width, unsigned i
 {
 	if (pixels && mTexture)
 	{
-		glBindTexture(GL_TEXTURE_2D, mTexture);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		StateCache::getDefault().bindTexture(mTexture);
+		UploadRing::getDefault().copyToTexture(x, y, width, height, pixels);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mIsSmooth ? GL_LINEAR : GL_NEAREST);
 		mHasMipmap = false;
 	}
@@ -103,7 +123,7 @@ void Texture::update(const Texture& texture)
 
 void Texture::update(const Texture& texture, unsigned int x, unsigned int y)
 {
-	if (!glIsTexture(mTexture) || !glIsTexture(texture.mTexture))
+	if (!isValid() || !texture.isValid())
 		return;
 
 	if (GL_EXT_framebuffer_object && GL_EXT_framebuffer_blit)
@@ -165,18 +185,18 @@ void Texture::update(const Texture& texture, unsigned int x, unsigned int y)
 
 Image Texture::copyToImage() const
 {
-	if (!glIsTexture(mTexture))
+	if (!isValid())
 		return Image();
 	std::vector<unsigned char> pixels(mSize.x * mSize.y * 4);
 	if ((mSize == mActualSize))
 	{
-		glBindTexture(GL_TEXTURE_2D, mTexture);
+		StateCache::getDefault().bindTexture(mTexture);
 		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
 	}
 	else
 	{
 		std::vector<unsigned char> allPixels(mActualSize.x * mActualSize.y * 4);
-		glBindTexture(GL_TEXTURE_2D, mTexture);
+		StateCache::getDefault().bindTexture(mTexture);
 		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &allPixels[0]);
 		const unsigned char* src = &allPixels[0];
 		unsigned char* dst = &pixels[0];
@@ -199,9 +219,9 @@ void Texture::setSmooth(bool smooth)
 	if (smooth != mIsSmooth)
 	{
 		mIsSmooth = smooth;
-		if (glIsTexture(mTexture))
+		if (isValid())
 		{
-			glBindTexture(GL_TEXTURE_2D, mTexture);
+			StateCache::getDefault().bindTexture(mTexture);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mIsSmooth ? GL_LINEAR : GL_NEAREST);
 			if (mHasMipmap)
 			{
@@ -222,9 +242,9 @@ bool Texture::isSmooth() const
 
 bool Texture::generateMipmap()
 {
-	if (!glIsTexture(mTexture))
+	if (!isValid())
 		return false;
-	glBindTexture(GL_TEXTURE_2D, mTexture);
+	StateCache::getDefault().bindTexture(mTexture);
 	glGenerateMipmap(GL_TEXTURE_2D);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mIsSmooth ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR);
 	mHasMipmap = true;
@@ -235,7 +255,7 @@ void Texture::invalidateMipmap()
 {
 	if (!mHasMipmap)
 		return;
-	glBindTexture(GL_TEXTURE_2D, mTexture);
+	StateCache::getDefault().bindTexture(mTexture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mIsSmooth ? GL_LINEAR : GL_NEAREST);
 	mHasMipmap = false;
 }
@@ -252,6 +272,9 @@ void Texture::swap(Texture& right)
 	std::swap(mActualSize, right.mActualSize);
 	std::swap(mIsSmooth, right.mIsSmooth);
 	std::swap(mHasMipmap, right.mHasMipmap);
+	const State state = getState();
+	setState(right.getState());
+	right.setState(state);
 }
 
 const glm::uvec2& Texture::getSize() const
@@ -261,18 +284,32 @@ const glm::uvec2& Texture::getSize() const
 
 void Texture::bind() const
 {
-	glBindTexture(GL_TEXTURE_2D, mTexture);
+	StateCache::getDefault().bindTexture(mTexture);
+}
+
+void Texture::bind(unsigned int unit) const
+{
+	StateCache::getDefault().bindTexture(unit, mTexture);
 }
 
 bool Texture::isValid() const
 {
-	return glIsTexture(mTexture) == GL_TRUE;
+	return mTexture != 0;
+}
+
+unsigned int Texture::getSortId() const
+{
+	return mSortId;
 }
 
 unsigned int Texture::getMaximumSize()
 {
-	GLint size = 0;
-	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+	// Queried once, a glGet stalls the pipeline
+	static GLint size = 0;
+	if (size == 0)
+	{
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+	}
 	return static_cast<unsigned int>(size);
 }
 
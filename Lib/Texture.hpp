@@ -1,13 +1,14 @@
 #pragma once
 
 #include "Image.hpp"
+#include "Resource.hpp"
 
 // TODO : Load From Memory
 
 namespace cmgl
 {
 
-class Texture
+class Texture : public Resource
 {
 	public:
 		Texture();
@@ -38,9 +39,14 @@ class Texture
 
 		const glm::uvec2& getSize() const;
 
+		// On the active texture unit, or on the given one
 		void bind() const;
+		void bind(unsigned int unit) const;
 		bool isValid() const;
 
+		// Given once at construction and never reused, render queues sort draws by it
+		unsigned int getSortId() const;
+
 		static unsigned int getMaximumSize();
 
 	private:
@@ -48,6 +54,7 @@ class Texture
 
 	private:
 		unsigned int mTexture;
+		unsigned int mSortId;
 		glm::uvec2 mSize;
 		glm::uvec2 mActualSize;
 		bool mIsSmooth;
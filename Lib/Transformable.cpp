@@ -16,6 +16,10 @@ Transformable::Transformable()
 {
 }
 
+Transformable::~Transformable()
+{
+}
+
 void Transformable::setTransform(const glm::vec3& position, const glm::vec3& scale, const glm::mat4& rotation)
 {
 	mPosition = position;
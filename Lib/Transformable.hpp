@@ -10,6 +10,7 @@ class Transformable
 {
 	public:
 		Transformable();
+		virtual ~Transformable();
 
 		void setTransform(const glm::vec3& position, const glm::vec3& scale, const glm::mat4& rotation);
 		const glm::mat4& getTransform() const;
@@ -35,7 +36,8 @@ class Transformable
 		const glm::mat4& getRotation() const;
 
 	protected:
-		void markAsDirty();
+		// Overridden by derived classes that cache data depending on the transform
+		virtual void markAsDirty();
 
 		bool isUpdated() const;
 
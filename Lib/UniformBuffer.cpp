@@ -0,0 +1,61 @@
+#include "UniformBuffer.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace cmgl
+{
+
+UniformBuffer::UniformBuffer()
+	: mAlignment(1)
+{
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	destroy();
+}
+
+bool UniformBuffer::create()
+{
+	destroy();
+
+	// Blocks start on the binding offset alignment
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	mAlignment = std::max<std::size_t>(1, (std::size_t)alignment);
+	return mBuffer.create();
+}
+
+void UniformBuffer::destroy()
+{
+	mBuffer.destroy();
+	mBlocks.clear();
+}
+
+void UniformBuffer::clear()
+{
+	mBlocks.clear();
+}
+
+std::size_t UniformBuffer::add(const void* block, std::size_t size)
+{
+	const std::size_t offset = (mBlocks.size() + mAlignment - 1) / mAlignment * mAlignment;
+	mBlocks.resize(offset + size);
+	std::memcpy(mBlocks.data() + offset, block, size);
+	return offset;
+}
+
+void UniformBuffer::upload()
+{
+	mBuffer.upload(mBlocks.data(), mBlocks.size());
+}
+
+void UniformBuffer::bind(unsigned int binding, std::size_t offset, std::size_t size) const
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, mBuffer.getBuffer(), offset, size);
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "StreamBuffer.hpp"
+
+namespace cmgl
+{
+
+// Uniform blocks of a frame gathered in a single buffer, every shader reading a binding point shares them
+// add() each block during the frame, upload() once, then bind() a block to the binding point its shaders read
+// Blocks must follow the std140 layout of their GLSL declaration
+class UniformBuffer
+{
+	public:
+		UniformBuffer();
+		~UniformBuffer();
+
+		UniformBuffer(const UniformBuffer&) = delete;
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+		bool create();
+		void destroy();
+
+		// Forgets the blocks of the previous frame
+		void clear();
+
+		// Returns the offset given to bind()
+		std::size_t add(const void* block, std::size_t size);
+
+		template <typename T>
+		std::size_t add(const T& block);
+
+		// Sends every block added since clear() through the upload ring
+		void upload();
+
+		void bind(unsigned int binding, std::size_t offset, std::size_t size) const;
+
+	private:
+		StreamBuffer mBuffer;
+		std::size_t mAlignment;
+		std::vector<unsigned char> mBlocks;
+};
+
+template <typename T>
+std::size_t UniformBuffer::add(const T& block)
+{
+	return add(&block, sizeof(T));
+}
+
+} // namespace cmgl
\ No newline at end of file
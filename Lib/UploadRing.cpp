@@ -0,0 +1,244 @@
+#include "UploadRing.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace cmgl
+{
+
+namespace priv
+{
+	const std::size_t upload_alignment = 16;
+
+	// A copy never takes more than a quarter of the ring, so that filling a chunk overlaps with the GPU reading the previous ones
+	const std::size_t upload_chunk_divisor = 4;
+}
+
+UploadRing::UploadRing()
+	: mBuffer(0)
+	, mData(nullptr)
+	, mSize(0)
+	, mHead(0)
+	, mTail(0)
+{
+}
+
+UploadRing::~UploadRing()
+{
+	destroy();
+}
+
+bool UploadRing::create(std::size_t size)
+{
+	destroy();
+	if (!GLEW_ARB_buffer_storage)
+	{
+		printf("Upload ring disabled, GL_ARB_buffer_storage is not supported\n");
+		return false;
+	}
+	if (size == 0)
+	{
+		fprintf(stderr, "Failed to create upload ring, invalid size\n");
+		return false;
+	}
+
+	// Coherent mapping : writes become visible to the GPU without any flush, the fences handle the reuse
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &mBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+	mData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	if (mData == nullptr)
+	{
+		fprintf(stderr, "Failed to map upload ring (%u bytes)\n", (unsigned int)size);
+		destroy();
+		return false;
+	}
+	mSize = size;
+	return true;
+}
+
+void UploadRing::destroy()
+{
+	for (std::size_t i = 0; i < mFences.size(); i++)
+	{
+		glDeleteSync(mFences[i].sync);
+	}
+	mFences.clear();
+	if (mBuffer != 0)
+	{
+		if (mData != nullptr)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &mBuffer);
+	}
+	mBuffer = 0;
+	mData = nullptr;
+	mSize = 0;
+	mHead = 0;
+	mTail = 0;
+}
+
+bool UploadRing::isValid() const
+{
+	return mData != nullptr;
+}
+
+void* UploadRing::allocate(std::size_t size, std::size_t alignment, std::size_t& offset)
+{
+	if (mData == nullptr || size == 0 || size > mSize || alignment == 0)
+	{
+		return nullptr;
+	}
+
+	for (;;)
+	{
+		// Offsets are aligned inside the buffer, a request that does not fit before the end starts the next lap
+		const std::size_t position = (std::size_t)(mHead % mSize);
+		std::size_t aligned = (position + alignment - 1) / alignment * alignment;
+		std::uint64_t start = mHead - position + aligned;
+		if (aligned + size > mSize)
+		{
+			start = mHead - position + mSize;
+		}
+		if (start + size - mTail <= mSize)
+		{
+			mHead = start + size;
+			offset = (std::size_t)(start % mSize);
+			return mData + offset;
+		}
+
+		if (mFences.empty())
+		{
+			if (mTail == mHead)
+			{
+				// Nothing in flight : restart at the beginning of the buffer
+				mHead = mTail = (position > 0) ? mHead - position + mSize : mHead;
+				continue;
+			}
+			fence();
+		}
+		retire(true);
+	}
+}
+
+void UploadRing::copyToBuffer(unsigned int buffer, std::size_t offset, const void* data, std::size_t size)
+{
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	const std::size_t chunkSize = mSize / priv::upload_chunk_divisor;
+	if (mData == nullptr || chunkSize == 0)
+	{
+		glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, bytes);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, mBuffer);
+	while (size > 0)
+	{
+		const std::size_t count = std::min(size, chunkSize);
+		std::size_t source = 0;
+		std::memcpy(allocate(count, priv::upload_alignment, source), bytes, count);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source, offset, count);
+		bytes += count;
+		offset += count;
+		size -= count;
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void UploadRing::copyToTexture(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* pixels)
+{
+	const std::size_t rowSize = (std::size_t)width * 4;
+	const std::size_t chunkRows = (mData != nullptr && rowSize > 0) ? (mSize / priv::upload_chunk_divisor) / rowSize : 0;
+	if (chunkRows == 0)
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		return;
+	}
+
+	// With a pixel unpack buffer bound, the pixel pointer is an offset into the ring
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mBuffer);
+	for (unsigned int row = 0; row < height; )
+	{
+		const unsigned int rows = (unsigned int)std::min<std::size_t>(chunkRows, height - row);
+		std::size_t source = 0;
+		std::memcpy(allocate(rows * rowSize, priv::upload_alignment, source), pixels + row * rowSize, rows * rowSize);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y + row, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(source));
+		row += rows;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void UploadRing::endFrame()
+{
+	if (mData == nullptr)
+	{
+		return;
+	}
+	if (mHead != mTail && (mFences.empty() || mFences.back().head != mHead))
+	{
+		fence();
+	}
+	while (retire(false))
+	{
+	}
+}
+
+unsigned int UploadRing::getBuffer() const
+{
+	return mBuffer;
+}
+
+std::size_t UploadRing::getSize() const
+{
+	return mSize;
+}
+
+UploadRing& UploadRing::getDefault()
+{
+	static UploadRing ring;
+	return ring;
+}
+
+void UploadRing::fence()
+{
+	Fence fence;
+	fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	fence.head = mHead;
+	mFences.push_back(fence);
+}
+
+bool UploadRing::retire(bool wait)
+{
+	if (mFences.empty())
+	{
+		return false;
+	}
+
+	const Fence& fence = mFences.front();
+	GLenum result = glClientWaitSync(fence.sync, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, 0);
+	while (wait && result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+	}
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return false;
+	}
+
+	// A failed wait releases the region too, rather than blocking forever
+	mTail = fence.head;
+	glDeleteSync(fence.sync);
+	mFences.pop_front();
+	return true;
+}
+
+} // namespace cmgl
\ No newline at end of file
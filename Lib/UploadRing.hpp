@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include <GL/glew.h>
+
+namespace cmgl
+{
+
+// Staging buffer shared by every upload : a persistently mapped ring that CPU data is copied into once,
+// the GPU then copies it to its destination or draws from it directly
+// Every frame's writes are fenced, a region is only reused once the GPU is done reading it
+// Without GL_ARB_buffer_storage the ring stays invalid and the copies fall back to glBufferSubData / glTexSubImage2D
+class UploadRing
+{
+	public:
+		UploadRing();
+		~UploadRing();
+
+		UploadRing(const UploadRing&) = delete;
+		UploadRing& operator=(const UploadRing&) = delete;
+
+		bool create(std::size_t size);
+		void destroy();
+		bool isValid() const;
+
+		// Reserves size bytes at a ring offset multiple of alignment, waits for older frames if the ring is full
+		// Returns the write pointer, nullptr when the ring is invalid or too small, the data must be used before the next allocation
+		void* allocate(std::size_t size, std::size_t alignment, std::size_t& offset);
+
+		// Large uploads go through the ring in several chunks
+		void copyToBuffer(unsigned int buffer, std::size_t offset, const void* data, std::size_t size);
+		// RGBA pixels into the texture currently bound to GL_TEXTURE_2D
+		void copyToTexture(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* pixels);
+
+		// Fences everything written since the last call, once per frame after the draws
+		void endFrame();
+
+		unsigned int getBuffer() const;
+		std::size_t getSize() const;
+
+		static UploadRing& getDefault();
+
+	private:
+		struct Fence
+		{
+			GLsync sync;
+			std::uint64_t head;
+		};
+
+		void fence();
+		bool retire(bool wait);
+
+	private:
+		unsigned int mBuffer;
+		unsigned char* mData;
+		std::size_t mSize;
+		std::uint64_t mHead; // Both positions only grow, the ring offset is position % size
+		std::uint64_t mTail;
+		std::deque<Fence> mFences;
+};
+
+} // namespace cmgl
\ No newline at end of file
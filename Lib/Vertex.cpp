@@ -1,8 +1,61 @@
 #include "Vertex.hpp"
 
+#include <glm/gtc/packing.hpp>
+
 namespace cmgl
 {
 
+namespace priv
+{
+	glm::vec2 octahedral_encode(const glm::vec3& normal)
+	{
+		const float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+		if (length <= 0.0f)
+		{
+			return glm::vec2(0.0f, 0.0f);
+		}
+		glm::vec2 e = glm::vec2(normal.x, normal.y) / length;
+		if (normal.z < 0.0f)
+		{
+			e = glm::vec2((1.0f - glm::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f), (1.0f - glm::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+		}
+		return e;
+	}
+
+	glm::vec3 octahedral_decode(const glm::vec2& e)
+	{
+		glm::vec3 n(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+		if (n.z < 0.0f)
+		{
+			n = glm::vec3((1.0f - glm::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f), (1.0f - glm::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f), n.z);
+		}
+		return glm::normalize(n);
+	}
+
+	unsigned short quantize_unorm16(float value)
+	{
+		return (unsigned short)(glm::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	short quantize_snorm16(float value)
+	{
+		const float scaled = glm::clamp(value, -1.0f, 1.0f) * 32767.0f;
+		return (short)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+	}
+
+	unsigned int quantize_snorm10(float value)
+	{
+		const float scaled = glm::clamp(value, -1.0f, 1.0f) * 511.0f;
+		return (unsigned int)(int)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f)) & 0x3FF;
+	}
+
+	float unpack_snorm10(unsigned int value)
+	{
+		const int signedValue = (value & 0x200) ? (int)value - 0x400 : (int)value;
+		return glm::max(signedValue / 511.0f, -1.0f);
+	}
+}
+
 Vertex::Vertex()
 	: position(glm::vec3(0.0))
 	, uv(glm::vec2(0.0))
@@ -38,4 +91,91 @@ Vertex::Vertex(const glm::vec3& p, const glm::vec2& u, const glm::vec3& n)
 {
 }
 
+PackedVertex::PackedVertex()
+{
+	position[0] = position[1] = position[2] = position[3] = 0;
+	normal[0] = 0;
+	normal[1] = 0;
+	uv[0] = 0;
+	uv[1] = 0;
+}
+
+PackedVertex::PackedVertex(const Vertex& vertex, const glm::vec3& offset, const glm::vec3& scale)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		position[i] = priv::quantize_unorm16((scale[i] > 0.0f) ? (vertex.position[i] - offset[i]) / scale[i] : 0.0f);
+	}
+	position[3] = 0;
+
+	const glm::vec2 octahedral = priv::octahedral_encode(vertex.normal);
+	normal[0] = priv::quantize_snorm16(octahedral.x);
+	normal[1] = priv::quantize_snorm16(octahedral.y);
+
+	uv[0] = glm::packHalf1x16(vertex.uv.x);
+	uv[1] = glm::packHalf1x16(vertex.uv.y);
+}
+
+Vertex PackedVertex::unpack(const glm::vec3& offset, const glm::vec3& scale) const
+{
+	const glm::vec3 p(position[0] / 65535.0f, position[1] / 65535.0f, position[2] / 65535.0f);
+	const glm::vec2 n(glm::max(normal[0] / 32767.0f, -1.0f), glm::max(normal[1] / 32767.0f, -1.0f));
+	return Vertex(offset + scale * p, glm::vec2(glm::unpackHalf1x16(uv[0]), glm::unpackHalf1x16(uv[1])), priv::octahedral_decode(n));
+}
+
+PackedTangent::PackedTangent()
+	: value(0)
+{
+}
+
+PackedTangent::PackedTangent(const glm::vec4& tangent)
+{
+	// w is 1 (01) or -2 (10) : both normalize to +1 and -1 under the GL 3.3 and GL 4.2+ snorm rules
+	const unsigned int w = (tangent.w < 0.0f) ? 2u : 1u;
+	value = priv::quantize_snorm10(tangent.x) | (priv::quantize_snorm10(tangent.y) << 10) | (priv::quantize_snorm10(tangent.z) << 20) | (w << 30);
+}
+
+glm::vec4 PackedTangent::unpack() const
+{
+	return glm::vec4(priv::unpack_snorm10(value & 0x3FF), priv::unpack_snorm10((value >> 10) & 0x3FF), priv::unpack_snorm10((value >> 20) & 0x3FF), (value >> 31) ? -1.0f : 1.0f);
+}
+
+SkinnedVertex::SkinnedVertex()
+	: position(glm::vec3(0.0))
+	, uv(glm::vec2(0.0))
+	, normal(glm::vec3(0.0, 1.0, 0.0))
+{
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		bones[i] = 0;
+		weights[i] = 0;
+	}
+	weights[0] = 255;
+}
+
+SkinnedVertex::SkinnedVertex(const Vertex& vertex)
+	: position(vertex.position)
+	, uv(vertex.uv)
+	, normal(vertex.normal)
+{
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		bones[i] = 0;
+		weights[i] = 0;
+	}
+	weights[0] = 255;
+}
+
+InstanceData::InstanceData()
+	: model(1.0f)
+	, normal(1.0f)
+{
+}
+
+InstanceData::InstanceData(const glm::mat4& model)
+	: model(model)
+	, normal(glm::transpose(glm::inverse(glm::mat3(model))))
+{
+}
+
 } // namespace cmgl
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include "VertexLayout.hpp"
+
 namespace cmgl
 {
 
@@ -16,6 +18,82 @@ struct Vertex
 	glm::vec3 position;
 	glm::vec2 uv;
 	glm::vec3 normal;
+
+	typedef VertexLayout<
+		Attribute<0, AttributeFloat, 3>,
+		Attribute<1, AttributeFloat, 2>,
+		Attribute<2, AttributeFloat, 3>> Layout;
+};
+
+// 16 bytes vertex, decoded in the vertex shader
+struct PackedVertex
+{
+	PackedVertex();
+	PackedVertex(const Vertex& vertex, const glm::vec3& offset, const glm::vec3& scale);
+
+	Vertex unpack(const glm::vec3& offset, const glm::vec3& scale) const;
+
+	unsigned short position[4]; // unorm16 relative to the quantization box (offset, scale), w unused
+	short normal[2]; // octahedral encoding, snorm16
+	unsigned short uv[2]; // half floats
+
+	typedef VertexLayout<
+		Attribute<0, AttributeUnsignedShort, 4, true>,
+		Attribute<2, AttributeShort, 2, true>,
+		Attribute<1, AttributeHalfFloat, 2>> Layout;
+};
+
+// Separate tangent stream, xyz as snorm10 and the bitangent sign in w : bitangent = w * cross(normal, tangent.xyz)
+struct PackedTangent
+{
+	PackedTangent();
+	explicit PackedTangent(const glm::vec4& tangent);
+
+	glm::vec4 unpack() const;
+
+	unsigned int value; // x in the low bits, 2-bit w on top
+
+	typedef VertexLayout<
+		Attribute<3, AttributeInt2101010, 4, true>> Layout;
+};
+
+// Vertex following up to four bones of a Skeleton, weights are unorm8 and sum to 255
+struct SkinnedVertex
+{
+	SkinnedVertex();
+	explicit SkinnedVertex(const Vertex& vertex);
+
+	glm::vec3 position;
+	glm::vec2 uv;
+	glm::vec3 normal;
+	unsigned char bones[4];
+	unsigned char weights[4];
+
+	typedef VertexLayout<
+		Attribute<0, AttributeFloat, 3>,
+		Attribute<1, AttributeFloat, 2>,
+		Attribute<2, AttributeFloat, 3>,
+		IntegerAttribute<4, AttributeUnsignedByte, 4>,
+		Attribute<5, AttributeUnsignedByte, 4, true>> Layout;
+};
+
+// Per-instance attributes of an instanced draw, advanced once per instance
+struct InstanceData
+{
+	InstanceData();
+	explicit InstanceData(const glm::mat4& model);
+
+	glm::mat4 model;
+	glm::mat3 normal; // inverse transpose of the model matrix
+
+	typedef VertexLayout<
+		Attribute<6, AttributeFloat, 4>,
+		Attribute<7, AttributeFloat, 4>,
+		Attribute<8, AttributeFloat, 4>,
+		Attribute<9, AttributeFloat, 4>,
+		Attribute<10, AttributeFloat, 3>,
+		Attribute<11, AttributeFloat, 3>,
+		Attribute<12, AttributeFloat, 3>> Layout;
 };
 
 } // namespace cmgl
\ No newline at end of file
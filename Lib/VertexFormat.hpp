@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include "VertexLayout.hpp"
+
+namespace cmgl
+{
+
+static_assert(AttributeByte == GL_BYTE && AttributeUnsignedByte == GL_UNSIGNED_BYTE
+	&& AttributeShort == GL_SHORT && AttributeUnsignedShort == GL_UNSIGNED_SHORT
+	&& AttributeInt == GL_INT && AttributeUnsignedInt == GL_UNSIGNED_INT
+	&& AttributeFloat == GL_FLOAT && AttributeHalfFloat == GL_HALF_FLOAT
+	&& AttributeInt2101010 == GL_INT_2_10_10_10_REV && AttributeUnsignedInt2101010 == GL_UNSIGNED_INT_2_10_10_10_REV,
+	"Attribute types must match the GL enums");
+
+namespace priv
+{
+	template <std::size_t Offset, typename... Attributes>
+	struct VertexAttributes
+	{
+		static void enable(GLsizei, std::size_t)
+		{
+		}
+
+		static void disable()
+		{
+		}
+
+		static void setDivisor(GLuint)
+		{
+		}
+	};
+
+	template <std::size_t Offset, typename First, typename... Others>
+	struct VertexAttributes<Offset, First, Others...>
+	{
+		typedef VertexAttributes<Offset + First::Size, Others...> Next;
+
+		static void enable(GLsizei stride, std::size_t base)
+		{
+			glEnableVertexAttribArray(First::Location);
+			First::pointer(stride, reinterpret_cast<const void*>(base + Offset));
+			Next::enable(stride, base);
+		}
+
+		static void disable()
+		{
+			glDisableVertexAttribArray(First::Location);
+			Next::disable();
+		}
+
+		static void setDivisor(GLuint divisor)
+		{
+			glVertexAttribDivisor(First::Location, divisor);
+			Next::setDivisor(divisor);
+		}
+	};
+}
+
+template <unsigned int AttributeLocation, unsigned int Type, int Count, bool Normalized>
+void Attribute<AttributeLocation, Type, Count, Normalized>::pointer(int stride, const void* offset)
+{
+	glVertexAttribPointer(Location, Count, Type, Normalized ? GL_TRUE : GL_FALSE, stride, offset);
+}
+
+template <unsigned int AttributeLocation, unsigned int Type, int Count>
+void IntegerAttribute<AttributeLocation, Type, Count>::pointer(int stride, const void* offset)
+{
+	glVertexAttribIPointer(Location, Count, Type, stride, offset);
+}
+
+template <typename... Attributes>
+void VertexLayout<Attributes...>::enable(std::size_t offset)
+{
+	priv::VertexAttributes<0, Attributes...>::enable(static_cast<GLsizei>(Stride), offset);
+}
+
+template <typename... Attributes>
+void VertexLayout<Attributes...>::disable()
+{
+	priv::VertexAttributes<0, Attributes...>::disable();
+}
+
+template <typename... Attributes>
+void VertexLayout<Attributes...>::setDivisor(unsigned int divisor)
+{
+	priv::VertexAttributes<0, Attributes...>::setDivisor(divisor);
+}
+
+// Type-erased layout, so that non-template code like Mesh can bind any vertex type
+struct VertexFormat
+{
+	std::size_t stride;
+	void (*enable)(std::size_t offset);
+	void (*disable)();
+};
+
+// TVertex must expose its layout as TVertex::Layout
+template <typename TVertex>
+VertexFormat getVertexFormat()
+{
+	static_assert(sizeof(TVertex) == TVertex::Layout::Stride, "Vertex layout does not match the vertex size");
+	VertexFormat format;
+	format.stride = TVertex::Layout::Stride;
+	format.enable = &TVertex::Layout::enable;
+	format.disable = &TVertex::Layout::disable;
+	return format;
+}
+
+} // namespace cmgl
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cmgl
+{
+
+// Component type of a vertex attribute, the values are the matching GL enums
+// Vertex types describe their layout with these so that they don't depend on the GL headers
+enum AttributeType
+{
+	AttributeByte = 0x1400, // GL_BYTE
+	AttributeUnsignedByte = 0x1401, // GL_UNSIGNED_BYTE
+	AttributeShort = 0x1402, // GL_SHORT
+	AttributeUnsignedShort = 0x1403, // GL_UNSIGNED_SHORT
+	AttributeInt = 0x1404, // GL_INT
+	AttributeUnsignedInt = 0x1405, // GL_UNSIGNED_INT
+	AttributeFloat = 0x1406, // GL_FLOAT
+	AttributeHalfFloat = 0x140B, // GL_HALF_FLOAT
+	AttributeInt2101010 = 0x8D9F, // GL_INT_2_10_10_10_REV
+	AttributeUnsignedInt2101010 = 0x8368 // GL_UNSIGNED_INT_2_10_10_10_REV
+};
+
+namespace priv
+{
+	template <unsigned int Type>
+	struct AttributeComponent;
+
+	template <> struct AttributeComponent<AttributeFloat> { static const std::size_t Size = 4; };
+	template <> struct AttributeComponent<AttributeHalfFloat> { static const std::size_t Size = 2; };
+	template <> struct AttributeComponent<AttributeInt> { static const std::size_t Size = 4; };
+	template <> struct AttributeComponent<AttributeUnsignedInt> { static const std::size_t Size = 4; };
+	template <> struct AttributeComponent<AttributeShort> { static const std::size_t Size = 2; };
+	template <> struct AttributeComponent<AttributeUnsignedShort> { static const std::size_t Size = 2; };
+	template <> struct AttributeComponent<AttributeByte> { static const std::size_t Size = 1; };
+	template <> struct AttributeComponent<AttributeUnsignedByte> { static const std::size_t Size = 1; };
+
+	template <unsigned int Type, int Count>
+	struct AttributeSize
+	{
+		static const std::size_t Size = AttributeComponent<Type>::Size * Count;
+	};
+
+	// Packed formats hold all four components in a single 32 bits word
+	template <> struct AttributeSize<AttributeInt2101010, 4> { static const std::size_t Size = 4; };
+	template <> struct AttributeSize<AttributeUnsignedInt2101010, 4> { static const std::size_t Size = 4; };
+
+	template <typename... Attributes>
+	struct VertexStride
+	{
+		static const std::size_t Size = 0;
+	};
+
+	template <typename First, typename... Others>
+	struct VertexStride<First, Others...>
+	{
+		static const std::size_t Size = First::Size + VertexStride<Others...>::Size;
+	};
+}
+
+// Float attribute : Count components of Type, bound to the shader input at Location
+// Integer types are converted to float, to [0,1] or [-1,1] when Normalized is true
+template <unsigned int AttributeLocation, unsigned int Type, int Count, bool Normalized = false>
+struct Attribute
+{
+	static const unsigned int Location = AttributeLocation;
+	static const std::size_t Size = priv::AttributeSize<Type, Count>::Size;
+
+	static void pointer(int stride, const void* offset);
+};
+
+// Integer attribute read as ivec/uvec by the shader (indices, flags)
+template <unsigned int AttributeLocation, unsigned int Type, int Count>
+struct IntegerAttribute
+{
+	static const unsigned int Location = AttributeLocation;
+	static const std::size_t Size = priv::AttributeSize<Type, Count>::Size;
+
+	static void pointer(int stride, const void* offset);
+};
+
+// Memory layout of a vertex type, attributes listed in the order they are stored
+// Strides and offsets are compile-time constants, enable() unrolls into the exact GL calls
+// The vertices start offset bytes into the bound GL_ARRAY_BUFFER
+// The GL calls are defined in VertexFormat.hpp, only the code binding vertices needs it
+template <typename... Attributes>
+struct VertexLayout
+{
+	static const std::size_t Stride = priv::VertexStride<Attributes...>::Size;
+	static const std::size_t AttributeCount = sizeof...(Attributes);
+
+	static void enable(std::size_t offset = 0);
+	static void disable();
+
+	// 0 advances the attributes per vertex, n once every n instances
+	static void setDivisor(unsigned int divisor);
+};
+
+} // namespace cmgl
\ No newline at end of file
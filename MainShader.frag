@@ -5,15 +5,27 @@ in vec2 UV;
 in vec3 Normal;
 
 uniform sampler2D Texture;
-uniform vec4 Ambient;
-uniform vec4 LightColor;
-uniform vec3 LightPosition; // eye-space
-uniform vec3 EyeDirection;
-uniform float Shininess;
-uniform float Strength;
-uniform float ConstantAttenuation;
-uniform float LinearAttenuation;
-uniform float QuadraticAttenuation;
+
+// Written once per frame, shared by every shader reading the same binding point
+layout (std140) uniform Frame
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Ambient;
+    vec4 LightColor;
+    vec3 LightPosition; // eye-space
+    vec3 EyeDirection;
+    float ConstantAttenuation;
+    float LinearAttenuation;
+    float QuadraticAttenuation;
+};
+
+layout (std140) uniform Material
+{
+    float Shininess;
+    float Strength;
+};
 
 out vec4 FragColor;
 
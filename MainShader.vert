@@ -3,20 +3,79 @@
 layout (location = 0) in vec3 vPos;
 layout (location = 1) in vec2 vUV;
 layout (location = 2) in vec3 vNormal;
+layout (location = 3) in vec4 vTangent; // xyz tangent, w bitangent sign
 
+// Instanced draws read each model matrix and its normal matrix per instance
+layout (location = 6) in mat4 vModel;
+layout (location = 10) in mat3 vModelNormal;
+
+// Single models only, world space draws take the view from the Frame block
 uniform mat4 MV;
 uniform mat3 N;
 uniform mat4 MVP;
 
+// Same block as MainShader.frag, written once per frame
+layout (std140) uniform Frame
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Ambient;
+    vec4 LightColor;
+    vec3 LightPosition; // eye-space
+    vec3 EyeDirection;
+    float ConstantAttenuation;
+    float LinearAttenuation;
+    float QuadraticAttenuation;
+};
+
+// Quantized meshes store positions in [0,1] over their bounding box and octahedral normals in xy
+uniform vec3 PositionOffset;
+uniform vec3 PositionScale;
+uniform bool OctahedralNormals;
+
+uniform bool Instanced;
+
+// Set for instanced draws and static batches, whose vertices end up in world space
+uniform bool WorldSpace;
+
 out vec3 Position;
 out vec2 UV;
 out vec3 Normal;
+out vec4 Tangent;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+    {
+        vec2 signNotZero = mix(vec2(-1.0), vec2(1.0), greaterThanEqual(n.xy, vec2(0.0)));
+        n.xy = (1.0 - abs(n.yx)) * signNotZero;
+    }
+    return normalize(n);
+}
 
 void main()
 {
-    Position = (MV * vec4(vPos, 1.0)).xyz;
+    vec3 pos = PositionOffset + PositionScale * vPos;
+    vec3 normal = OctahedralNormals ? decodeOctahedral(vNormal.xy) : vNormal;
+    vec3 tangent = vTangent.xyz;
+    vec4 world = vec4(pos, 1.0);
+    if (Instanced)
+    {
+        world = vModel * world;
+        normal = vModelNormal * normal;
+        tangent = mat3(vModel) * tangent;
+    }
+
+    // The view is a rigid transform, its upper 3x3 also transforms the normals
+    mat4 modelView = WorldSpace ? View : MV;
+    mat3 normalMatrix = WorldSpace ? mat3(View) : N;
+
+    Position = (modelView * world).xyz;
     UV = vUV;
-    Normal = normalize(N * vNormal);
+    Normal = normalize(normalMatrix * normal);
+    Tangent = vec4(normalize(normalMatrix * tangent), vTangent.w);
 
-    gl_Position = MVP * vec4(vPos, 1.0);
+    gl_Position = (WorldSpace ? ViewProjection : MVP) * world;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 330 core
+
+layout (location = 0) in vec3 vPos;
+layout (location = 1) in vec2 vUV;
+layout (location = 2) in vec3 vNormal;
+layout (location = 4) in uvec4 vBones;
+layout (location = 5) in vec4 vWeights;
+
+uniform mat4 MV;
+uniform mat3 N;
+uniform mat4 MVP;
+
+// One range of a PaletteBuffer per character
+layout (std140) uniform BonePalette
+{
+    mat4 Bones[256];
+};
+
+out vec3 Position;
+out vec2 UV;
+out vec3 Normal;
+
+void main()
+{
+    mat4 skin = Bones[vBones.x] * vWeights.x + Bones[vBones.y] * vWeights.y + Bones[vBones.z] * vWeights.z + Bones[vBones.w] * vWeights.w;
+    vec4 pos = skin * vec4(vPos, 1.0);
+
+    Position = (MV * pos).xyz;
+    UV = vUV;
+    Normal = normalize(N * (mat3(skin) * vNormal));
+
+    gl_Position = MVP * pos;
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+// Round trip of the MeshCodec vertex and index streams on a generated grid or an OBJ model, with the decode throughput of each
+// Build : g++ -O2 -std=c++14 -I. Tests/MeshCodecTest.cpp Lib/MeshCodec.cpp Lib/MeshOptimizer.cpp Lib/ObjLoader.cpp Lib/MappedFile.cpp Lib/Vertex.cpp -pthread
+// Usage : MeshCodecTest [gridSize | file.obj] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Lib/MeshCodec.hpp"
+#include "Lib/MeshOptimizer.hpp"
+#include "Lib/ObjLoader.hpp"
+
+namespace
+{
+	// Same 16 bytes as a quantized vertex : snorm16 position and padding, octahedral normal, half-like uv
+	struct TestVertex
+	{
+		std::uint16_t position[4];
+		std::int16_t normal[2];
+		std::uint16_t uv[2];
+	};
+
+	static_assert(sizeof(TestVertex) == sizeof(cmgl::PackedVertex), "Test vertices must match the quantized vertex size");
+
+	// Row by row grid on a wave, the order optimizeVertexFetch gives a scanned surface
+	void generate_grid(unsigned int size, std::vector<TestVertex>& vertices, std::vector<std::uint32_t>& indices)
+	{
+		vertices.resize(size * size);
+		for (unsigned int y = 0; y < size; y++)
+		{
+			for (unsigned int x = 0; x < size; x++)
+			{
+				const float u = (float)x / (size - 1);
+				const float v = (float)y / (size - 1);
+				const float height = 0.5f + 0.25f * std::sin(u * 12.0f) * std::cos(v * 9.0f);
+				TestVertex& vertex = vertices[y * size + x];
+				vertex.position[0] = (std::uint16_t)(u * 65535.0f);
+				vertex.position[1] = (std::uint16_t)(height * 65535.0f);
+				vertex.position[2] = (std::uint16_t)(v * 65535.0f);
+				vertex.position[3] = 0;
+				vertex.normal[0] = (std::int16_t)(std::cos(u * 12.0f) * 8000.0f);
+				vertex.normal[1] = (std::int16_t)(std::sin(v * 9.0f) * 8000.0f);
+				vertex.uv[0] = (std::uint16_t)(u * 30000.0f);
+				vertex.uv[1] = (std::uint16_t)(v * 30000.0f);
+			}
+		}
+
+		indices.clear();
+		indices.reserve((size - 1) * (size - 1) * 6);
+		for (unsigned int y = 0; y + 1 < size; y++)
+		{
+			for (unsigned int x = 0; x + 1 < size; x++)
+			{
+				const std::uint32_t corner = y * size + x;
+				const std::uint32_t quad[6] = { corner, corner + size, corner + 1, corner + 1, corner + size, corner + size + 1 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	// Real geometry as the mesh cache stores it : welded, in vertex cache and vertex fetch order, quantized to PackedVertex
+	bool load_model(const std::string& filename, std::vector<TestVertex>& vertices, std::vector<std::uint32_t>& indices)
+	{
+		std::vector<cmgl::Vertex> source;
+		std::vector<unsigned int> sourceIndices;
+		std::vector<cmgl::SubMesh> subMeshes;
+		if (!cmgl::loadObj(filename, source, sourceIndices, subMeshes) || source.empty())
+		{
+			return false;
+		}
+
+		// loadObj indexes every sub-mesh from its base vertex, the test codes a single range
+		for (std::size_t s = 0; s < subMeshes.size(); s++)
+		{
+			for (unsigned int i = 0; i < subMeshes[s].indexCount; i++)
+			{
+				sourceIndices[subMeshes[s].indexOffset + i] += subMeshes[s].baseVertex;
+			}
+		}
+		source.resize(cmgl::weldVertices(source.data(), source.size(), sourceIndices.data(), sourceIndices.size()));
+		cmgl::optimizeVertexCache(sourceIndices.data(), sourceIndices.size(), source.size());
+		source.resize(cmgl::optimizeVertexFetch(source.data(), source.size(), sourceIndices.data(), sourceIndices.size()));
+
+		glm::vec3 minimum = source[0].position;
+		glm::vec3 maximum = minimum;
+		for (std::size_t i = 1; i < source.size(); i++)
+		{
+			minimum = glm::min(minimum, source[i].position);
+			maximum = glm::max(maximum, source[i].position);
+		}
+		vertices.resize(source.size());
+		for (std::size_t i = 0; i < source.size(); i++)
+		{
+			const cmgl::PackedVertex packed(source[i], minimum, maximum - minimum);
+			std::memcpy(&vertices[i], &packed, sizeof(TestVertex));
+		}
+		indices.assign(sourceIndices.begin(), sourceIndices.end());
+		return true;
+	}
+
+	// The index codec keeps the winding and the triangle order but may rotate each triangle
+	template <typename T>
+	bool same_triangles(const std::vector<T>& expected, const std::vector<T>& decoded)
+	{
+		for (std::size_t i = 0; i + 2 < expected.size(); i += 3)
+		{
+			bool found = false;
+			for (std::size_t r = 0; r < 3 && !found; r++)
+			{
+				found = expected[i] == decoded[i + r] && expected[i + 1] == decoded[i + (r + 1) % 3] && expected[i + 2] == decoded[i + (r + 2) % 3];
+			}
+			if (!found)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Best decode time of the iterations, in seconds
+	template <typename Decode>
+	double best_time(unsigned int iterations, Decode decode, bool& success)
+	{
+		double best = 0.0;
+		success = true;
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			success = decode() && success;
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (i == 0 || seconds < best)
+			{
+				best = seconds;
+			}
+		}
+		return best;
+	}
+
+	void report(const char* name, std::size_t rawSize, std::size_t encodedSize, double seconds)
+	{
+		printf("%-10s : %9u -> %9u bytes (%5.1f%%), decode %6.2f GB/s\n", name, (unsigned int)rawSize, (unsigned int)encodedSize, 100.0 * encodedSize / rawSize, rawSize / seconds / 1e9);
+	}
+
+	bool check(bool condition, const char* what)
+	{
+		if (!condition)
+		{
+			fprintf(stderr, "FAILED : %s\n", what);
+		}
+		return condition;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::string input = (argc > 1) ? argv[1] : "250";
+	const bool model = input.size() > 4 && input.compare(input.size() - 4, 4, ".obj") == 0;
+	const unsigned int size = model ? 0 : (unsigned int)std::max(2, atoi(input.c_str()));
+	const unsigned int iterations = (argc > 2) ? (unsigned int)std::max(1, atoi(argv[2])) : 20;
+
+	std::vector<TestVertex> vertices;
+	std::vector<std::uint32_t> indices;
+	if (!model)
+	{
+		generate_grid(size, vertices, indices);
+	}
+	else if (!load_model(input, vertices, indices))
+	{
+		fprintf(stderr, "Failed to load %s\n", input.c_str());
+		return 1;
+	}
+	std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+	const bool shortFits = vertices.size() <= 65536;
+
+	bool passed = true;
+	std::vector<unsigned char> encodedVertices;
+	std::vector<unsigned char> encodedIndices;
+	std::vector<unsigned char> encodedShortIndices;
+	passed = check(cmgl::encodeVertexBuffer(encodedVertices, vertices.data(), vertices.size(), sizeof(TestVertex)), "vertex encoding") && passed;
+	passed = check(cmgl::encodeIndexBuffer(encodedIndices, indices.data(), indices.size(), sizeof(std::uint32_t)), "32-bit index encoding") && passed;
+	if (shortFits)
+	{
+		passed = check(cmgl::encodeIndexBuffer(encodedShortIndices, shortIndices.data(), shortIndices.size(), sizeof(std::uint16_t)), "16-bit index encoding") && passed;
+	}
+
+	std::vector<TestVertex> decodedVertices(vertices.size());
+	std::vector<std::uint32_t> decodedIndices(indices.size());
+	std::vector<std::uint16_t> decodedShortIndices(shortIndices.size());
+	bool decoded = false;
+	const double vertexTime = best_time(iterations, [&]() { return cmgl::decodeVertexBuffer(decodedVertices.data(), decodedVertices.size(), sizeof(TestVertex), encodedVertices.data(), encodedVertices.size()); }, decoded);
+	passed = check(decoded && std::equal(vertices.begin(), vertices.end(), decodedVertices.begin(), [](const TestVertex& a, const TestVertex& b) { return std::equal((const unsigned char*)&a, (const unsigned char*)(&a + 1), (const unsigned char*)&b); }), "vertex round trip") && passed;
+	const double indexTime = best_time(iterations, [&]() { return cmgl::decodeIndexBuffer(decodedIndices.data(), decodedIndices.size(), sizeof(std::uint32_t), encodedIndices.data(), encodedIndices.size()); }, decoded);
+	passed = check(decoded && same_triangles(indices, decodedIndices), "32-bit index round trip") && passed;
+	double shortIndexTime = 0.0;
+	if (shortFits)
+	{
+		shortIndexTime = best_time(iterations, [&]() { return cmgl::decodeIndexBuffer(decodedShortIndices.data(), decodedShortIndices.size(), sizeof(std::uint16_t), encodedShortIndices.data(), encodedShortIndices.size()); }, decoded);
+		passed = check(decoded && same_triangles(shortIndices, decodedShortIndices), "16-bit index round trip") && passed;
+	}
+
+	// Sizes the format cannot represent and truncated streams must fail instead of writing garbage
+	std::vector<unsigned char> rejected;
+	passed = check(!cmgl::encodeVertexBuffer(rejected, vertices.data(), vertices.size(), sizeof(TestVertex) - 1), "odd vertex size rejected by the encoder") && passed;
+	passed = check(!cmgl::decodeVertexBuffer(decodedVertices.data(), decodedVertices.size(), sizeof(TestVertex) - 1, encodedVertices.data(), encodedVertices.size()), "odd vertex size rejected by the decoder") && passed;
+	passed = check(!cmgl::encodeIndexBuffer(rejected, indices.data(), indices.size(), 3), "index size rejected by the encoder") && passed;
+	passed = check(!cmgl::decodeVertexBuffer(decodedVertices.data(), decodedVertices.size(), sizeof(TestVertex), encodedVertices.data(), encodedVertices.size() / 2), "truncated vertex stream rejected") && passed;
+	passed = check(!cmgl::decodeIndexBuffer(decodedIndices.data(), decodedIndices.size(), sizeof(std::uint32_t), encodedIndices.data(), encodedIndices.size() / 2), "truncated index stream rejected") && passed;
+
+	if (model)
+	{
+		printf("%s : %u vertices, %u triangles, best of %u\n", input.c_str(), (unsigned int)vertices.size(), (unsigned int)(indices.size() / 3), iterations);
+	}
+	else
+	{
+		printf("Grid %ux%u : %u vertices, %u triangles, best of %u\n", size, size, (unsigned int)vertices.size(), (unsigned int)(indices.size() / 3), iterations);
+	}
+	report("Vertices", vertices.size() * sizeof(TestVertex), encodedVertices.size(), vertexTime);
+	report("Indices32", indices.size() * sizeof(std::uint32_t), encodedIndices.size(), indexTime);
+	if (shortFits)
+	{
+		report("Indices16", shortIndices.size() * sizeof(std::uint16_t), encodedShortIndices.size(), shortIndexTime);
+	}
+	printf("%s\n", passed ? "Round trip passed" : "Round trip FAILED");
+	return passed ? 0 : 1;
+}
\ No newline at end of file
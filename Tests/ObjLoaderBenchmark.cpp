@@ -0,0 +1,260 @@
+// Parse throughput of the native OBJ reader against the Assimp import Mesh::loadFromFile uses for other formats
+// Build : g++ -O2 -std=c++14 -I. Tests/ObjLoaderBenchmark.cpp Lib/ObjLoader.cpp Lib/MappedFile.cpp Lib/Vertex.cpp -lassimp -pthread
+// Usage : ObjLoaderBenchmark [--copies N] file.obj [iterations]
+// --copies writes N copies of the file side by side to a temporary file and benchmarks that, e.g. a scaled-up suzanne.obj
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include "Lib/ObjLoader.hpp"
+
+namespace
+{
+	struct Result
+	{
+		double milliseconds;
+		std::size_t vertexCount;
+		std::size_t triangleCount;
+	};
+
+	double elapsed_milliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	bool run_native(const std::string& filename, Result& result)
+	{
+		std::vector<cmgl::Vertex> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<cmgl::SubMesh> subMeshes;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (!cmgl::loadObj(filename, vertices, indices, subMeshes))
+		{
+			return false;
+		}
+		result.milliseconds = elapsed_milliseconds(start);
+		result.vertexCount = vertices.size();
+		result.triangleCount = indices.size() / 3;
+		return true;
+	}
+
+	// Same post-processing as the Assimp path of Mesh::loadFromFile, which welds and triangulates like loadObj
+	bool run_assimp(const std::string& filename, Result& result)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(filename, aiProcessPreset_TargetRealtime_Fast & ~aiProcess_CalcTangentSpace);
+		if (!scene)
+		{
+			fprintf(stderr, "Assimp failed : %s\n", importer.GetErrorString());
+			return false;
+		}
+		result.milliseconds = elapsed_milliseconds(start);
+		result.vertexCount = 0;
+		result.triangleCount = 0;
+		for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+		{
+			result.vertexCount += scene->mMeshes[m]->mNumVertices;
+			result.triangleCount += scene->mMeshes[m]->mNumFaces;
+		}
+		return true;
+	}
+
+	// Offsets the positive v/vt/vn indices of a face corner, relative (negative) indices stay valid as they are
+	std::string offset_corner(const std::string& corner, const unsigned int* offsets)
+	{
+		std::string result;
+		std::size_t start = 0;
+		for (int attribute = 0; attribute < 3 && start <= corner.size(); attribute++)
+		{
+			std::size_t end = corner.find('/', start);
+			if (end == std::string::npos)
+			{
+				end = corner.size();
+			}
+			const std::string value = corner.substr(start, end - start);
+			const long index = value.empty() ? 0 : atol(value.c_str());
+			if (attribute > 0)
+			{
+				result += '/';
+			}
+			result += (index > 0) ? std::to_string(index + offsets[attribute]) : value;
+			start = end + 1;
+		}
+		return result;
+	}
+
+	// Copies of the model spaced along x, each face pointing to the vertices of its own copy
+	bool write_copies(const std::string& filename, unsigned int copies, const std::string& output)
+	{
+		std::ifstream input(filename, std::ios::binary);
+		if (!input)
+		{
+			fprintf(stderr, "Failed to open %s\n", filename.c_str());
+			return false;
+		}
+		std::vector<std::string> lines;
+		unsigned int counts[3] = { 0, 0, 0 };
+		float minX = 0.0f;
+		float maxX = 0.0f;
+		std::string line;
+		while (std::getline(input, line))
+		{
+			if (!line.empty() && line[line.size() - 1] == '\r')
+			{
+				line.erase(line.size() - 1);
+			}
+			if (line.compare(0, 2, "v ") == 0)
+			{
+				const float x = strtof(line.c_str() + 2, nullptr);
+				minX = (counts[0] == 0) ? x : std::min(minX, x);
+				maxX = (counts[0] == 0) ? x : std::max(maxX, x);
+				counts[0]++;
+			}
+			else if (line.compare(0, 3, "vt ") == 0)
+			{
+				counts[1]++;
+			}
+			else if (line.compare(0, 3, "vn ") == 0)
+			{
+				counts[2]++;
+			}
+			lines.push_back(line);
+		}
+
+		FILE* file = fopen(output.c_str(), "wb");
+		if (file == nullptr)
+		{
+			fprintf(stderr, "Failed to create %s\n", output.c_str());
+			return false;
+		}
+		const float spacing = (maxX - minX) * 1.25f + 1.0f;
+		for (unsigned int c = 0; c < copies; c++)
+		{
+			const unsigned int offsets[3] = { counts[0] * c, counts[1] * c, counts[2] * c };
+			for (std::size_t l = 0; l < lines.size(); l++)
+			{
+				const std::string& source = lines[l];
+				if (source.compare(0, 2, "v ") == 0)
+				{
+					char* rest = nullptr;
+					const float x = strtof(source.c_str() + 2, &rest);
+					fprintf(file, "v %f%s\n", x + spacing * (float)c, rest);
+				}
+				else if (source.compare(0, 2, "f ") == 0)
+				{
+					fputs("f", file);
+					std::size_t start = source.find_first_not_of(' ', 2);
+					while (start != std::string::npos)
+					{
+						const std::size_t end = std::min(source.find(' ', start), source.size());
+						fprintf(file, " %s", offset_corner(source.substr(start, end - start), offsets).c_str());
+						start = source.find_first_not_of(' ', end);
+					}
+					fputs("\n", file);
+				}
+				else
+				{
+					fprintf(file, "%s\n", source.c_str());
+				}
+			}
+		}
+		return fclose(file) == 0;
+	}
+
+	std::string temporary_path(const std::string& name)
+	{
+		const char* variables[] = { "TMPDIR", "TEMP", "TMP" };
+		for (const char* variable : variables)
+		{
+			const char* directory = getenv(variable);
+			if (directory != nullptr && directory[0] != '\0')
+			{
+				return std::string(directory) + "/" + name;
+			}
+		}
+		return "/tmp/" + name;
+	}
+
+	// Best of the iterations, the first one also warms the page cache
+	bool best_of(bool (*run)(const std::string&, Result&), const std::string& filename, unsigned int iterations, Result& best)
+	{
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			Result result;
+			if (!run(filename, result))
+			{
+				return false;
+			}
+			if (i == 0 || result.milliseconds < best.milliseconds)
+			{
+				best = result;
+			}
+		}
+		return true;
+	}
+
+	int benchmark(const std::string& filename, const std::string& name, unsigned int iterations)
+	{
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			fprintf(stderr, "Failed to open %s\n", filename.c_str());
+			return 1;
+		}
+		const double megabytes = (double)file.tellg() / (1024.0 * 1024.0);
+
+		Result native;
+		Result assimp;
+		if (!best_of(run_native, filename, iterations, native) || !best_of(run_assimp, filename, iterations, assimp))
+		{
+			return 1;
+		}
+
+		printf("%s : %.1f MB, best of %u\n", name.c_str(), megabytes, iterations);
+		printf("loadObj : %8.1f ms, %7.1f MB/s, %u vertices, %u triangles\n", native.milliseconds, megabytes * 1000.0 / native.milliseconds, (unsigned int)native.vertexCount, (unsigned int)native.triangleCount);
+		printf("Assimp  : %8.1f ms, %7.1f MB/s, %u vertices, %u triangles\n", assimp.milliseconds, megabytes * 1000.0 / assimp.milliseconds, (unsigned int)assimp.vertexCount, (unsigned int)assimp.triangleCount);
+		printf("Speedup : %.2fx\n", assimp.milliseconds / native.milliseconds);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int argument = 1;
+	unsigned int copies = 0;
+	if (argc > 3 && std::string(argv[1]) == "--copies")
+	{
+		copies = (unsigned int)std::max(1, atoi(argv[2]));
+		argument = 3;
+	}
+	if (argc <= argument)
+	{
+		printf("Usage : %s [--copies N] file.obj [iterations]\n", argv[0]);
+		return 1;
+	}
+	const std::string filename = argv[argument];
+	const unsigned int iterations = (argc > argument + 1) ? (unsigned int)std::max(1, atoi(argv[argument + 1])) : 5;
+	if (copies == 0)
+	{
+		return benchmark(filename, filename, iterations);
+	}
+
+	const std::string copiesFilename = temporary_path("ObjLoaderBenchmark.obj");
+	if (!write_copies(filename, copies, copiesFilename))
+	{
+		return 1;
+	}
+	const int status = benchmark(copiesFilename, filename + " x" + std::to_string(copies), iterations);
+	std::remove(copiesFilename.c_str());
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+// Throughput of skinVertices against a plain single-threaded loop, on random vertices and bones
+// Build : g++ -O2 -std=c++14 -I. Tests/SkinningBenchmark.cpp Lib/Skinning.cpp Lib/Vertex.cpp -pthread
+// Usage : SkinningBenchmark [vertexCount] [boneCount] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Lib/Skinning.hpp"
+
+namespace
+{
+	// Up to four influences per vertex, weights summing to 255 like the import gives them
+	void generate_vertices(std::size_t vertexCount, std::size_t boneCount, std::vector<cmgl::SkinnedVertex>& vertices)
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+		std::uniform_int_distribution<unsigned int> bone(0, (unsigned int)boneCount - 1);
+		vertices.resize(vertexCount);
+		for (std::size_t i = 0; i < vertexCount; i++)
+		{
+			cmgl::SkinnedVertex& vertex = vertices[i];
+			vertex.position = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+			vertex.normal = glm::normalize(glm::vec3(coordinate(random), coordinate(random), coordinate(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+			vertex.uv = glm::vec2(coordinate(random), coordinate(random));
+			const unsigned int influences = 1 + (unsigned int)(i % 4);
+			unsigned int left = 255;
+			for (unsigned int k = 0; k < 4; k++)
+			{
+				const unsigned int weight = (k + 1 == influences) ? left : std::min(left, 40u + (unsigned int)(random() % 80));
+				vertex.bones[k] = (unsigned char)bone(random);
+				vertex.weights[k] = (unsigned char)((k < influences) ? weight : 0);
+				left -= (k < influences) ? weight : 0;
+			}
+		}
+	}
+
+	void generate_palette(std::size_t boneCount, std::vector<glm::mat4>& palette)
+	{
+		std::mt19937 random(2);
+		std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+		std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+		palette.resize(boneCount);
+		for (std::size_t i = 0; i < boneCount; i++)
+		{
+			const glm::vec3 axis = glm::normalize(glm::vec3(offset(random), offset(random), offset(random)) + glm::vec3(0.0f, 1.0f, 0.0f));
+			palette[i] = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(offset(random), offset(random), offset(random))), angle(random), axis);
+		}
+	}
+
+	// The blend skinVertices is measured against, one vertex at a time on a single thread
+	void skin_reference(const std::vector<cmgl::SkinnedVertex>& vertices, const std::vector<glm::mat4>& palette, std::vector<cmgl::Vertex>& output)
+	{
+		for (std::size_t i = 0; i < vertices.size(); i++)
+		{
+			const cmgl::SkinnedVertex& vertex = vertices[i];
+			glm::mat4 skin(0.0f);
+			for (unsigned int k = 0; k < 4; k++)
+			{
+				skin = skin + palette[vertex.bones[k]] * (vertex.weights[k] / 255.0f);
+			}
+			output[i].position = glm::vec3(skin * glm::vec4(vertex.position, 1.0f));
+			output[i].uv = vertex.uv;
+			output[i].normal = glm::normalize(glm::vec3(skin * glm::vec4(vertex.normal, 0.0f)));
+		}
+	}
+
+	// Best time of the iterations, in seconds
+	template <typename Run>
+	double best_time(unsigned int iterations, Run run)
+	{
+		double best = 0.0;
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			run();
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (i == 0 || seconds < best)
+			{
+				best = seconds;
+			}
+		}
+		return best;
+	}
+
+	float max_difference(const glm::vec3& a, const glm::vec3& b)
+	{
+		return std::max(std::fabs(a.x - b.x), std::max(std::fabs(a.y - b.y), std::fabs(a.z - b.z)));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t vertexCount = (argc > 1) ? (std::size_t)std::max(1, atoi(argv[1])) : 1000000;
+	const std::size_t boneCount = (argc > 2) ? (std::size_t)std::min(256, std::max(1, atoi(argv[2]))) : 64;
+	const unsigned int iterations = (argc > 3) ? (unsigned int)std::max(1, atoi(argv[3])) : 10;
+
+	std::vector<cmgl::SkinnedVertex> vertices;
+	std::vector<glm::mat4> palette;
+	generate_vertices(vertexCount, boneCount, vertices);
+	generate_palette(boneCount, palette);
+
+	std::vector<cmgl::Vertex> expected(vertexCount);
+	std::vector<cmgl::Vertex> output(vertexCount);
+	const double referenceTime = best_time(iterations, [&]() { skin_reference(vertices, palette, expected); });
+	const double skinTime = best_time(iterations, [&]() { cmgl::skinVertices(vertices.data(), vertices.size(), palette.data(), output.data()); });
+
+	float positionError = 0.0f;
+	float normalError = 0.0f;
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		positionError = std::max(positionError, max_difference(expected[i].position, output[i].position));
+		normalError = std::max(normalError, max_difference(expected[i].normal, output[i].normal));
+	}
+
+	printf("%u vertices, %u bones, best of %u\n", (unsigned int)vertexCount, (unsigned int)boneCount, iterations);
+	printf("Reference    : %8.2f ms, %8.1f M vertices/s\n", referenceTime * 1000.0, vertexCount / referenceTime / 1e6);
+	printf("skinVertices : %8.2f ms, %8.1f M vertices/s, %.2fx\n", skinTime * 1000.0, vertexCount / skinTime / 1e6, referenceTime / skinTime);
+	printf("Max error : %g on positions, %g on normals\n", positionError, normalError);
+
+	const bool passed = positionError < 1e-4f && normalError < 1e-4f;
+	printf("%s\n", passed ? "Results match" : "Results DIFFER");
+	return passed ? 0 : 1;
+}
\ No newline at end of file
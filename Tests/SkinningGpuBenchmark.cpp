@@ -0,0 +1,225 @@
+// GPU time of skinned draws through PaletteBuffer and SkinnedShader.vert, measured with timer queries
+// Build : g++ -O2 -std=c++14 -I. Tests/SkinningGpuBenchmark.cpp $(ls Lib/*.cpp | grep -v ImGuiWrapper) -lglfw -lGLEW -lGL -lassimp -pthread
+// Usage : SkinningGpuBenchmark [characterCount] [gridSize] [frames], from the repository root for the shader
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Lib/GeometryArena.hpp"
+#include "Lib/Mesh.hpp"
+#include "Lib/PaletteBuffer.hpp"
+#include "Lib/Shader.hpp"
+#include "Lib/Skeleton.hpp"
+#include "Lib/UploadRing.hpp"
+#include "Lib/Window.hpp"
+
+namespace
+{
+	const unsigned int palette_binding = 0;
+	const std::size_t bone_count = 64;
+	const unsigned int warmup_frames = 10;
+
+	// Shading stays trivial, the vertex stage is what is measured
+	const char* fragment_source =
+		"#version 330 core\n"
+		"in vec3 Normal;\n"
+		"out vec4 FragColor;\n"
+		"void main()\n"
+		"{\n"
+		"    FragColor = vec4(Normal * 0.5 + 0.5, 1.0);\n"
+		"}\n";
+
+	bool read_file(const std::string& filename, std::string& content)
+	{
+		std::ifstream file(filename);
+		if (!file)
+		{
+			fprintf(stderr, "Failed to open %s\n", filename.c_str());
+			return false;
+		}
+		std::stringstream stream;
+		stream << file.rdbuf();
+		content = stream.str();
+		return true;
+	}
+
+	// Flat strip bent by a chain of bones along x, every vertex blends the two nearest bones
+	void generate_strip(unsigned int size, std::vector<cmgl::SkinnedVertex>& vertices, std::vector<unsigned int>& indices)
+	{
+		vertices.resize(size * size);
+		for (unsigned int y = 0; y < size; y++)
+		{
+			for (unsigned int x = 0; x < size; x++)
+			{
+				const float u = (float)x / (size - 1);
+				const float v = (float)y / (size - 1);
+				const float bone = u * (bone_count - 1);
+				const unsigned int first = std::min((unsigned int)bone, (unsigned int)bone_count - 2);
+				const unsigned char weight = (unsigned char)((bone - first) * 255.0f);
+				cmgl::SkinnedVertex& vertex = vertices[y * size + x];
+				vertex.position = glm::vec3(u * 4.0f - 2.0f, 0.0f, v - 0.5f);
+				vertex.uv = glm::vec2(u, v);
+				vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+				vertex.bones[0] = (unsigned char)first;
+				vertex.bones[1] = (unsigned char)(first + 1);
+				vertex.weights[0] = (unsigned char)(255 - weight);
+				vertex.weights[1] = weight;
+			}
+		}
+
+		indices.clear();
+		indices.reserve((size - 1) * (size - 1) * 6);
+		for (unsigned int y = 0; y + 1 < size; y++)
+		{
+			for (unsigned int x = 0; x + 1 < size; x++)
+			{
+				const unsigned int corner = y * size + x;
+				const unsigned int quad[6] = { corner, corner + size, corner + 1, corner + 1, corner + size, corner + size + 1 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	void build_skeleton(cmgl::Skeleton& skeleton)
+	{
+		const float length = 4.0f / (bone_count - 1);
+		for (std::size_t i = 0; i < bone_count; i++)
+		{
+			const glm::vec3 offset = (i == 0) ? glm::vec3(-2.0f, 0.0f, 0.0f) : glm::vec3(length, 0.0f, 0.0f);
+			const glm::mat4 inverseBind = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f - i * length, 0.0f, 0.0f));
+			skeleton.addBone("bone", (int)i - 1, glm::translate(glm::mat4(1.0f), offset), inverseBind);
+		}
+	}
+
+	// Every character waves with its own phase, so that no two palettes are the same
+	void animate(const cmgl::Skeleton& skeleton, float time, cmgl::Pose& pose)
+	{
+		for (std::size_t i = 1; i < skeleton.getBoneCount(); i++)
+		{
+			const float angle = 0.1f * std::sin(time * 3.0f + i * 0.2f);
+			pose.setLocalTransform(i, glm::rotate(skeleton.getBone(i).bindTransform, angle, glm::vec3(0.0f, 0.0f, 1.0f)));
+		}
+		pose.computePalette(skeleton);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int characterCount = (argc > 1) ? (unsigned int)std::max(1, atoi(argv[1])) : 64;
+	const unsigned int size = (argc > 2) ? (unsigned int)std::max(2, atoi(argv[2])) : 128;
+	const unsigned int frameCount = (argc > 3) ? (unsigned int)std::max(1, atoi(argv[3])) : 200;
+
+	cmgl::Window window;
+	if (!window.create(1024, 768, "SkinningGpuBenchmark"))
+	{
+		return 1;
+	}
+	cmgl::UploadRing::getDefault().create(32 * 1024 * 1024);
+	cmgl::GeometryArena::getDefault().create(16 * 1024 * 1024, 8 * 1024 * 1024, 1024 * 1024);
+	glEnable(GL_DEPTH_TEST);
+
+	std::string vertexSource;
+	cmgl::Shader shader;
+	cmgl::PaletteBuffer palettes;
+	if (!read_file("SkinnedShader.vert", vertexSource) || !shader.loadFromSource(vertexSource, fragment_source) || !palettes.create(palette_binding))
+	{
+		return 1;
+	}
+	shader.setUniformBlock("BonePalette", palette_binding);
+	const cmgl::UniformHandle<glm::mat4> mvHandle = shader.getUniformHandle<glm::mat4>("MV");
+	const cmgl::UniformHandle<glm::mat3> nHandle = shader.getUniformHandle<glm::mat3>("N");
+	const cmgl::UniformHandle<glm::mat4> mvpHandle = shader.getUniformHandle<glm::mat4>("MVP");
+
+	std::vector<cmgl::SkinnedVertex> vertices;
+	std::vector<unsigned int> indices;
+	generate_strip(size, vertices, indices);
+	cmgl::Mesh mesh;
+	if (!mesh.loadFromMemory(vertices.data(), vertices.size(), indices.data(), indices.size()))
+	{
+		return 1;
+	}
+
+	cmgl::Skeleton skeleton;
+	build_skeleton(skeleton);
+	std::vector<cmgl::Pose> poses(characterCount);
+	for (std::size_t c = 0; c < poses.size(); c++)
+	{
+		poses[c].reset(skeleton);
+	}
+
+	// Characters on a square grid in front of the camera
+	const unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)characterCount));
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f * columns, 3.0f * columns), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1024.0f / 768.0f, 0.1f, 20.0f * columns);
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+	std::vector<std::size_t> handles(characterCount);
+	double totalMilliseconds = 0.0;
+	double bestMilliseconds = 0.0;
+	unsigned int measured = 0;
+	for (unsigned int frame = 0; frame < warmup_frames + frameCount && window.isOpen(); frame++)
+	{
+		window.pollEvents();
+		window.clear();
+
+		// Palettes are sampled and uploaded outside the query, only the draws are timed
+		palettes.clear();
+		for (unsigned int c = 0; c < characterCount; c++)
+		{
+			animate(skeleton, frame / 60.0f + c, poses[c]);
+			handles[c] = palettes.add(poses[c].getPalette(), poses[c].getBoneCount());
+		}
+		palettes.upload();
+
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		shader.bind();
+		for (unsigned int c = 0; c < characterCount; c++)
+		{
+			const glm::vec3 position(5.0f * ((c % columns) - 0.5f * columns), 0.0f, 2.0f * ((c / columns) - 0.5f * columns));
+			const glm::mat4 mv = view * glm::translate(glm::mat4(1.0f), position);
+			shader.setUniform(mvHandle, mv);
+			shader.setUniform(nHandle, glm::mat3(mv));
+			shader.setUniform(mvpHandle, projection * mv);
+			palettes.bind(handles[c]);
+			mesh.draw();
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+		if (frame >= warmup_frames)
+		{
+			const double milliseconds = nanoseconds / 1e6;
+			totalMilliseconds += milliseconds;
+			bestMilliseconds = (measured == 0) ? milliseconds : std::min(bestMilliseconds, milliseconds);
+			measured++;
+		}
+
+		window.display();
+		cmgl::UploadRing::getDefault().endFrame();
+	}
+	glDeleteQueries(1, &query);
+
+	if (measured == 0)
+	{
+		return 1;
+	}
+	const double skinnedVertices = (double)characterCount * vertices.size();
+	printf("%u characters of %u vertices and %u bones, %u frames\n", characterCount, (unsigned int)vertices.size(), (unsigned int)bone_count, measured);
+	printf("GPU skinning : %.3f ms average, %.3f ms best, %.1f M vertices/s\n", totalMilliseconds / measured, bestMilliseconds, skinnedVertices / bestMilliseconds / 1e3);
+
+	palettes.destroy();
+	cmgl::GeometryArena::getDefault().destroy();
+	cmgl::UploadRing::getDefault().destroy();
+	return 0;
+}
\ No newline at end of file